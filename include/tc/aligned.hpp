@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>			// std::size_t
+#include <memory>			// std::unique_ptr, std::uninitialized_value_construct_n
+#include <new>				// std::align_val_t
+#include <type_traits>		// std::bool_constant, std::false_type, std::integral_constant, std::is_trivial_v, std::void_t
+
+
+namespace tc {
+	namespace aligned {
+
+		// Alignment of aligned storage in bytes, one cache line and one AVX-512 register.
+		constexpr inline std::size_t alignment = 64;
+
+		// Strides that are a multiple of this many bytes map every line to the same cache sets and alias in the store buffer.
+		constexpr inline std::size_t aliasing_period = 4096;
+
+		// Deleter for arrays obtained from allocate.
+		struct deleter {
+			template<typename T>
+			void operator()(T* p) const
+			{
+				::operator delete(p, std::align_val_t{alignment});
+			}
+		};
+
+		// Owning pointer to an array obtained from allocate.
+		template<typename T>
+		using unique_array = std::unique_ptr<T[], deleter>;
+
+		/* Allocates an array of `n` value-initialised (zeroed) elements, aligned to `alignment` bytes.
+			The allocation is rounded up to a whole number of cache lines, so full vector loads of the last line stay
+			inside it. */
+		template<typename T>
+		unique_array<T> allocate(std::size_t n)
+		{
+			static_assert(std::is_trivial_v<T>, "aligned storage holds trivial types only");
+
+			if (n == 0) {
+				return nullptr;
+			}
+
+			std::size_t const bytes = (n * sizeof(T) + alignment - 1) / alignment * alignment;
+			T* const p = static_cast<T*>(::operator new(bytes, std::align_val_t{alignment}));
+
+			std::uninitialized_value_construct_n(p, n);
+			return unique_array<T>{p};
+		}
+
+		/* Gets a stride for lines of `length` elements which keeps every line aligned to `alignment` bytes.
+			`length` is rounded up to a whole number of cache lines, then one more line is added if the stride would be a
+			multiple of aliasing_period, as it is for power-of-two widths. */
+		template<typename T>
+		constexpr std::size_t padded_stride(std::size_t length)
+		{
+			constexpr std::size_t line = alignment % sizeof(T) == 0 ? alignment / sizeof(T) : 1;
+
+			std::size_t stride = (length + line - 1) / line * line;
+
+			if (stride != 0 && (stride * sizeof(T)) % aliasing_period == 0) {
+				stride += line;
+			}
+			return stride;
+		}
+
+
+		/* Returns `p`, telling the compiler it is aligned to `Alignment` bytes so loops over it need no alignment peeling.
+			Has no effect for alignments no stricter than that of T, or with compilers other than GCC and Clang. */
+		template<std::size_t Alignment, typename T>
+		T* assume_aligned(T* p)
+		{
+			#if defined(__GNUC__)
+				if constexpr (Alignment > alignof(T)) {
+					return static_cast<T*>(__builtin_assume_aligned(p, Alignment));
+				}
+			#endif
+
+			return p;
+		}
+
+
+		/* Alignment traits */
+
+		/* Provides member constant `value`, the alignment in bytes guaranteed for data() of a matrix or vector type.
+			Types without an `alignment` member constant only guarantee the alignment of their value type. */
+		template<class T, typename = void>
+		struct alignment_of : std::integral_constant<std::size_t, alignof(typename T::value_type)> {};
+
+		/* Provides member constant `value`, the alignment in bytes guaranteed for data() of a matrix or vector type.
+			Specialisation for types with an `alignment` member constant. */
+		template<class T>
+		struct alignment_of<T, std::void_t<decltype(T::alignment)>> : std::integral_constant<std::size_t, T::alignment> {};
+
+		// Alignment in bytes guaranteed for data() of a matrix or vector type.
+		template<class T>
+		constexpr inline std::size_t alignment_of_v = alignment_of<T>::value;
+
+		/* std::true_type if every line (row, or column if column major) of a matrix type starts at alignment_of_v,
+			ie its stride is padded, otherwise std::false_type.
+			Types without an `is_padded` member constant are not padded. */
+		template<class T, typename = void>
+		struct is_padded : std::false_type {};
+
+		/* std::true_type if every line (row, or column if column major) of a matrix type starts at alignment_of_v,
+			ie its stride is padded, otherwise std::false_type.
+			Specialisation for types with an `is_padded` member constant. */
+		template<class T>
+		struct is_padded<T, std::void_t<decltype(T::is_padded)>> : std::bool_constant<T::is_padded> {};
+
+		// true if every line of a matrix type starts at alignment_of_v, otherwise false.
+		template<class T>
+		constexpr inline bool is_padded_v = is_padded<T>::value;
+
+	}
+}
@@ -0,0 +1,524 @@
+#pragma once
+
+#include <algorithm>		// std::fill, std::max, std::min
+#include <array>			// std::array
+#ifdef _DEBUG
+	#include <cassert>		// assert
+#endif
+#include <cstddef>			// std::size_t
+#include <tuple>			// std::tuple_size_v
+#include <type_traits>		// std::decay_t
+#include <utility>			// std::declval, std::index_sequence, std::index_sequence_for, std::swap
+#include "array_view.hpp"	// tc::array_view::dimensions
+#include "parallel.hpp"		// tc::parallel::chunk_size, tc::parallel::for_each_chunk
+#include "workspace.hpp"		// tc::workspace::scope
+
+
+namespace tc {
+	namespace array_ops {
+
+		/* Elementwise operations and reductions of N-dimensional arrays (tc::array_view::array_view, strided or with static
+			extents).
+			The dimensions of the operands are reordered to follow the memory order of the result, and adjacent dimensions
+			that every operand steps through as one are merged, so that contiguous arrays are walked as flat lines whose
+			inner loops vectorise. Lines (or long segments of a line) are split across threads. */
+
+		// Number of dimensions of an array.
+		template<class Array>
+		constexpr inline std::size_t rank_v = std::tuple_size_v<std::decay_t<decltype(std::declval<Array const&>().dim_sizes())>>;
+
+		/* Shape and strides of the operands of an operation, after make_layout.
+			Dimensions 0 to rank - 1 are in use, rank - 1 being the innermost (the lines). */
+		template<std::size_t N, std::size_t Operands>
+		struct layout {
+			std::size_t rank;
+			tc::array_view::dimensions<N> dims;
+			std::array<tc::array_view::dimensions<N>, Operands> strides;
+		};
+
+		/* Gets the strides, in `dims`, of `in` broadcast to dimensions `dims`, NumPy style.
+			The dimensions of `in` are aligned with the last of `dims`, and each must be the same size or 1, checked for debug
+			builds. Dimensions of size 1 and missing leading dimensions are broadcast with stride 0. */
+		template<std::size_t N, class InputArray>
+		tc::array_view::dimensions<N> broadcast_strides(InputArray const& in, [[maybe_unused]] tc::array_view::dimensions<N> const& dims)
+		{
+			constexpr std::size_t M = rank_v<InputArray>;
+
+			static_assert(M <= N, "an input cannot have more dimensions than the result");
+
+			tc::array_view::dimensions<N> strides{};
+
+			for (std::size_t i = 0; i < M; ++i) {
+				std::size_t const d = N - M + i;
+
+				#ifdef _DEBUG
+					assert(in.dim_size(i) == dims[d] || in.dim_size(i) == 1);
+				#endif
+
+				strides[d] = in.dim_size(i) == 1 ? 0 : in.stride(i);
+			}
+
+			return strides;
+		}
+
+		/* Gets the layout of operands of dimensions `dims` and the given strides (in elements, per operand).
+			The dimensions are ordered by decreasing stride of operand 0, dimensions of size 1 are dropped, and each dimension
+			is merged into the one outside it when every operand's outer stride is its stride times its size. */
+		template<std::size_t N, std::size_t Operands>
+		layout<N, Operands> make_layout(tc::array_view::dimensions<N> const& dims, std::array<tc::array_view::dimensions<N>, Operands> const& strides)
+		{
+			std::array<std::size_t, N> order{};
+
+			for (std::size_t i = 0; i < N; ++i) {
+				order[i] = i;
+
+				for (std::size_t j = i; j > 0 && strides[0][order[j - 1]] < strides[0][order[j]]; --j) {
+					std::swap(order[j - 1], order[j]);
+				}
+			}
+
+			layout<N, Operands> shape{};
+
+			for (std::size_t const i : order) {
+				if (dims[i] == 1) {
+					continue;
+				}
+
+				if (shape.rank > 0) {
+					std::size_t const last = shape.rank - 1;
+					bool merge = true;
+
+					for (std::size_t k = 0; k < Operands; ++k) {
+						merge = merge && strides[k][i] * dims[i] == shape.strides[k][last];
+					}
+
+					if (merge) {
+						shape.dims[last] *= dims[i];
+
+						for (std::size_t k = 0; k < Operands; ++k) {
+							shape.strides[k][last] = strides[k][i];
+						}
+						continue;
+					}
+				}
+
+				shape.dims[shape.rank] = dims[i];
+
+				for (std::size_t k = 0; k < Operands; ++k) {
+					shape.strides[k][shape.rank] = strides[k][i];
+				}
+				++shape.rank;
+			}
+
+			// A single element.
+			if (shape.rank == 0) {
+				shape.rank = 1;
+				shape.dims[0] = 1;
+			}
+
+			return shape;
+		}
+
+		/* Fewest elements of a line handled by a task, so that a task reading a strided slice of a bigger array (eg
+			summing the rows of a matrix) still reads whole cache lines and pages of each row. */
+		constexpr inline std::size_t min_segment_length = 1024;
+
+		// Gets the number of elements of a line handled by each task, for `depth` elements read per element of the line.
+		inline std::size_t segment_length(std::size_t depth)
+		{
+			return std::max<std::size_t>(tc::parallel::chunk_size / std::max<std::size_t>(depth, 1), min_segment_length);
+		}
+
+		// Gets the number of tasks for_each_line splits `shape` into.
+		template<std::size_t N, std::size_t Operands>
+		std::size_t task_count(layout<N, Operands> const& shape, std::size_t depth = 1)
+		{
+			std::size_t const length = shape.dims[shape.rank - 1];
+			std::size_t const segment = segment_length(depth);
+			std::size_t lines = 1;
+
+			for (std::size_t d = 0; d + 1 < shape.rank; ++d) {
+				lines *= shape.dims[d];
+			}
+
+			if (length >= segment) {
+				return lines * ((length + segment - 1) / segment);
+			}
+
+			std::size_t const lines_per_task = segment / std::max<std::size_t>(length, 1);
+
+			return (lines + lines_per_task - 1) / lines_per_task;
+		}
+
+		/* Calls line(task, offsets, length) for every line of `shape`, split across threads.
+			`offsets` holds the offset of the start of the line in each operand, and `length` is its number of elements,
+			each operand stepping through them by its innermost stride. `depth` is the number of elements read per element
+			of a line, to size the tasks.
+			Lines shorter than segment_length(depth) are grouped into tasks of consecutive lines, called in order, and longer
+			lines are cut into segments of that length, one per task. `task` is the index of the task in
+			[0, task_count(shape, depth)), so that results can be gathered per task independently of the number of threads. */
+		template<std::size_t N, std::size_t Operands, typename Line>
+		void for_each_line(layout<N, Operands> const& shape, Line line, std::size_t depth = 1)
+		{
+			std::size_t const outer = shape.rank - 1;
+			std::size_t const length = shape.dims[outer];
+			std::size_t const segment = segment_length(depth);
+			std::size_t lines = 1;
+
+			for (std::size_t d = 0; d < outer; ++d) {
+				lines *= shape.dims[d];
+			}
+
+			// Offsets of the start of line `l` in each operand, with the index of each outer dimension.
+			auto const locate = [&](std::size_t l, tc::array_view::dimensions<N>& index) {
+				std::array<std::size_t, Operands> offsets{};
+
+				for (std::size_t d = outer; d > 0; --d) {
+					index[d - 1] = l % shape.dims[d - 1];
+					l /= shape.dims[d - 1];
+
+					for (std::size_t k = 0; k < Operands; ++k) {
+						offsets[k] += index[d - 1] * shape.strides[k][d - 1];
+					}
+				}
+
+				return offsets;
+			};
+
+			if (length >= segment) {
+				std::size_t const segments = (length + segment - 1) / segment;
+
+				tc::parallel::for_each_chunk(lines * segments, [&](std::size_t begin, std::size_t end) {
+					for (std::size_t task = begin; task < end; ++task) {
+						tc::array_view::dimensions<N> index{};
+						std::array<std::size_t, Operands> offsets = locate(task / segments, index);
+						std::size_t const first = task % segments * segment;
+
+						for (std::size_t k = 0; k < Operands; ++k) {
+							offsets[k] += first * shape.strides[k][outer];
+						}
+
+						line(task, offsets, std::min(segment, length - first));
+					}
+				}, 1);
+				return;
+			}
+
+			std::size_t const lines_per_task = segment / std::max<std::size_t>(length, 1);
+
+			tc::parallel::for_each_chunk(lines, [&](std::size_t begin, std::size_t end) {
+				std::size_t const task = begin / lines_per_task;
+				tc::array_view::dimensions<N> index{};
+				std::array<std::size_t, Operands> offsets = locate(begin, index);
+
+				for (std::size_t l = begin; l < end; ++l) {
+					line(task, offsets, length);
+
+					// Step to the next line, carrying into the outer dimensions.
+					for (std::size_t d = outer; d > 0; --d) {
+						for (std::size_t k = 0; k < Operands; ++k) {
+							offsets[k] += shape.strides[k][d - 1];
+						}
+
+						if (++index[d - 1] < shape.dims[d - 1]) {
+							break;
+						}
+
+						for (std::size_t k = 0; k < Operands; ++k) {
+							offsets[k] -= shape.dims[d - 1] * shape.strides[k][d - 1];
+						}
+						index[d - 1] = 0;
+					}
+				}
+			}, lines_per_task);
+		}
+
+		/* Serial reduction of term(i) over [begin, end) with an associative and commutative operation, end > begin.
+			Uses several independent accumulators so the loop vectorises, they are combined pairwise at the end. */
+		template<typename T, typename Term, typename Operation>
+		T reduce_range(std::size_t begin, std::size_t end, Term term, Operation operation)
+		{
+			constexpr std::size_t lanes = 8;
+
+			#ifdef _DEBUG
+				assert(end > begin);
+			#endif
+
+			if (end - begin < lanes) {
+				T acc = term(begin);
+
+				for (std::size_t i = begin + 1; i < end; ++i) {
+					acc = operation(acc, term(i));
+				}
+				return acc;
+			}
+
+			T acc[lanes];
+			std::size_t i = begin;
+
+			for (std::size_t j = 0; j < lanes; ++j, ++i) {
+				acc[j] = term(i);
+			}
+			for (; i + lanes <= end; i += lanes) {
+				for (std::size_t j = 0; j < lanes; ++j) {
+					acc[j] = operation(acc[j], term(i + j));
+				}
+			}
+			for (std::size_t j = 0; i < end; ++i, ++j) {
+				acc[j] = operation(acc[j], term(i));
+			}
+
+			for (std::size_t width = lanes / 2; width > 0; width /= 2) {
+				for (std::size_t j = 0; j < width; ++j) {
+					acc[j] = operation(acc[j], acc[j + width]);
+				}
+			}
+
+			return acc[0];
+		}
+
+		/* Sets out[k] = function(in[k]...) along every line of `shape`, operand 0 being `out` and operand i + 1 `in[i]`.
+			Lines that are contiguous in every operand are walked with unit stride, so the loop vectorises. */
+		template<std::size_t... I, std::size_t N, std::size_t Operands, typename Function, typename OutputPointer, typename... InputPointers>
+		void map_layout(std::index_sequence<I...>, layout<N, Operands> const& shape, Function& function, OutputPointer out, InputPointers... in)
+		{
+			std::size_t const out_stride = shape.strides[0][shape.rank - 1];
+			std::array<std::size_t, sizeof...(I)> const in_strides{shape.strides[I + 1][shape.rank - 1]...};
+			bool const unit = out_stride == 1 && ((in_strides[I] == 1) && ...);
+
+			for_each_line(shape, [&](std::size_t, std::array<std::size_t, Operands> const& offsets, std::size_t length) {
+				auto const dst = out + offsets[0];
+
+				if (unit) {
+					for (std::size_t e = 0; e < length; ++e) {
+						dst[e] = function((in + offsets[I + 1])[e]...);
+					}
+				}
+				else {
+					for (std::size_t e = 0; e < length; ++e) {
+						dst[e * out_stride] = function((in + offsets[I + 1])[e * in_strides[I]]...);
+					}
+				}
+			});
+		}
+
+		/* Sets result(indices...) = function(in(indices...)...) for every element, NumPy style broadcasting each input to
+			the dimensions of `result` (see broadcast_strides). With two inputs this zips them, eg
+			a_map(result, std::plus<>{}, lhs, rhs). Inputs may be `result` itself. */
+		template<class OutputArray, typename Function, class... InputArrays>
+		void a_map(OutputArray& result, Function function, InputArrays const&... in)
+		{
+			constexpr std::size_t N = rank_v<OutputArray>;
+
+			if (result.size() == 0) {
+				return;
+			}
+
+			auto const dims = result.dim_sizes();
+			std::array<tc::array_view::dimensions<N>, 1 + sizeof...(InputArrays)> const strides{
+				tc::array_view::dimensions<N>(result.strides()),
+				broadcast_strides(in, dims)...
+			};
+
+			map_layout(std::index_sequence_for<InputArrays...>{}, make_layout(dims, strides), function, result.data(), in.data()...);
+		}
+
+		/* Reduces `in` with an associative and commutative operation to a single value, result = operation(...(x0, x1)...).
+			`in` must not be empty, checked for debug builds. Each task reduces its lines into a partial result, and the
+			partial results are combined in task order, so the result does not depend on the number of threads. */
+		template<class InputArray, typename Operation, typename Element>
+		void a_reduce(InputArray const& in, Operation operation, Element& result)
+		{
+			constexpr std::size_t N = rank_v<InputArray>;
+
+			#ifdef _DEBUG
+				assert(in.size() > 0);
+			#endif
+
+			std::array<tc::array_view::dimensions<N>, 1> const strides{tc::array_view::dimensions<N>(in.strides())};
+			auto const shape = make_layout(in.dim_sizes(), strides);
+			std::size_t const stride = shape.strides[0][shape.rank - 1];
+			std::size_t const tasks = task_count(shape);
+
+			tc::workspace::scope scratch;
+			Element* const partial = scratch.allocate<Element>(tasks);
+			bool* const started = scratch.allocate<bool>(tasks);
+			auto const src = in.data();
+
+			std::fill(started, started + tasks, false);
+
+			for_each_line(shape, [&](std::size_t task, std::array<std::size_t, 1> const& offsets, std::size_t length) {
+				auto const p = src + offsets[0];
+				Element const value = stride == 1
+					? reduce_range<Element>(0, length, [=](std::size_t e){ return static_cast<Element>(p[e]); }, operation)
+					: reduce_range<Element>(0, length, [=](std::size_t e){ return static_cast<Element>(p[e * stride]); }, operation);
+
+				partial[task] = started[task] ? operation(partial[task], value) : value;
+				started[task] = true;
+			});
+
+			result = reduce_range<Element>(0, tasks, [=](std::size_t i){ return partial[i]; }, operation);
+		}
+
+		/* Reduces `in` along dimension `axis` with an associative and commutative operation,
+			result(..., i, j, ...) = operation(...(in(..., i, 0, j, ...), in(..., i, 1, j, ...))...).
+			`result` has the dimensions of `in` with `axis` removed, and `axis` must not be empty, checked for debug builds.
+			When `axis` is the innermost dimension of `in` (in memory order) each element is reduced along it, otherwise the
+			result is accumulated a slice at a time, walking contiguous lines of `in` and `result` together. */
+		template<class InputArray, typename Operation, class OutputArray>
+		void a_reduce(InputArray const& in, std::size_t axis, Operation operation, OutputArray& result)
+		{
+			constexpr std::size_t N = rank_v<InputArray>;
+
+			static_assert(N > 1, "a one dimensional array reduces to a single value");
+			static_assert(rank_v<OutputArray> == N - 1, "the result has one dimension less than the input");
+
+			using value_type = typename OutputArray::value_type;
+
+			#ifdef _DEBUG
+				assert(axis < N);
+				assert(in.dim_size(axis) > 0);
+			#endif
+
+			tc::array_view::dimensions<N - 1> dims{};
+			std::array<tc::array_view::dimensions<N - 1>, 2> strides{};
+
+			for (std::size_t i = 0, j = 0; i < N; ++i) {
+				if (i != axis) {
+					#ifdef _DEBUG
+						assert(result.dim_size(j) == in.dim_size(i));
+					#endif
+
+					dims[j] = in.dim_size(i);
+					strides[0][j] = result.stride(j);
+					strides[1][j] = in.stride(i);
+					++j;
+				}
+			}
+
+			if (result.size() == 0) {
+				return;
+			}
+
+			auto const shape = make_layout(dims, strides);
+			std::size_t const n = in.dim_size(axis);
+			std::size_t const axis_stride = in.stride(axis);
+			std::size_t const out_stride = shape.strides[0][shape.rank - 1];
+			std::size_t const in_stride = shape.strides[1][shape.rank - 1];
+			auto const dst = result.data();
+			auto const src = in.data();
+
+			if (axis_stride <= in_stride) {
+				for_each_line(shape, [&](std::size_t, std::array<std::size_t, 2> const& offsets, std::size_t length) {
+					for (std::size_t e = 0; e < length; ++e) {
+						auto const p = src + offsets[1] + e * in_stride;
+
+						dst[offsets[0] + e * out_stride] = axis_stride == 1
+							? reduce_range<value_type>(0, n, [=](std::size_t k){ return static_cast<value_type>(p[k]); }, operation)
+							: reduce_range<value_type>(0, n, [=](std::size_t k){ return static_cast<value_type>(p[k * axis_stride]); }, operation);
+					}
+				}, n);
+				return;
+			}
+
+			bool const unit = out_stride == 1 && in_stride == 1;
+
+			for_each_line(shape, [&](std::size_t, std::array<std::size_t, 2> const& offsets, std::size_t length) {
+				auto const out = dst + offsets[0];
+				auto const p = src + offsets[1];
+
+				if (unit) {
+					for (std::size_t e = 0; e < length; ++e) {
+						out[e] = static_cast<value_type>(p[e]);
+					}
+					for (std::size_t k = 1; k < n; ++k) {
+						auto const q = p + k * axis_stride;
+
+						for (std::size_t e = 0; e < length; ++e) {
+							out[e] = operation(out[e], static_cast<value_type>(q[e]));
+						}
+					}
+				}
+				else {
+					for (std::size_t e = 0; e < length; ++e) {
+						out[e * out_stride] = static_cast<value_type>(p[e * in_stride]);
+					}
+					for (std::size_t k = 1; k < n; ++k) {
+						auto const q = p + k * axis_stride;
+
+						for (std::size_t e = 0; e < length; ++e) {
+							out[e * out_stride] = operation(out[e * out_stride], static_cast<value_type>(q[e * in_stride]));
+						}
+					}
+				}
+			}, n);
+		}
+
+		// Larger of two values, the reduction of a_max.
+		struct maximum {
+			template<typename T>
+			T operator()(T const& lhs, T const& rhs) const
+			{
+				return lhs < rhs ? rhs : lhs;
+			}
+		};
+
+		// Sum of two values, the reduction of a_sum and a_mean.
+		struct plus {
+			template<typename T>
+			T operator()(T const& lhs, T const& rhs) const
+			{
+				return lhs + rhs;
+			}
+		};
+
+		// Largest element of an array, which must not be empty.
+		template<class InputArray, typename Element>
+		void a_max(InputArray const& in, Element& result)
+		{
+			a_reduce(in, maximum{}, result);
+		}
+
+		// Largest elements along dimension `axis`, see a_reduce.
+		template<class InputArray, class OutputArray>
+		void a_max(InputArray const& in, std::size_t axis, OutputArray& result)
+		{
+			a_reduce(in, axis, maximum{}, result);
+		}
+
+		// Mean of the elements of an array, which must not be empty.
+		template<class InputArray, typename Element>
+		void a_mean(InputArray const& in, Element& result)
+		{
+			a_reduce(in, plus{}, result);
+			result /= static_cast<Element>(in.size());
+		}
+
+		// Means along dimension `axis`, see a_reduce.
+		template<class InputArray, class OutputArray>
+		void a_mean(InputArray const& in, std::size_t axis, OutputArray& result)
+		{
+			using value_type = typename OutputArray::value_type;
+
+			value_type const n = static_cast<value_type>(in.dim_size(axis));
+
+			a_reduce(in, axis, plus{}, result);
+			a_map(result, [=](value_type x){ return x / n; }, result);
+		}
+
+		// Sum of the elements of an array, which must not be empty.
+		template<class InputArray, typename Element>
+		void a_sum(InputArray const& in, Element& result)
+		{
+			a_reduce(in, plus{}, result);
+		}
+
+		// Sums along dimension `axis`, see a_reduce.
+		template<class InputArray, class OutputArray>
+		void a_sum(InputArray const& in, std::size_t axis, OutputArray& result)
+		{
+			a_reduce(in, axis, plus{}, result);
+		}
+
+	}
+}
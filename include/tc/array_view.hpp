@@ -9,6 +9,7 @@
 #include <memory>			// std::pointer_traits
 #include <stdexcept>		// std::out_of_range
 #include <type_traits>		// std::remove_cv_t, std::enable_if_t
+#include <utility>			// std::index_sequence, std::make_index_sequence
 
 
 namespace tc {
@@ -127,10 +128,179 @@ namespace tc {
 			return offset;
 		}
 
+		/* Converts a set of N-dimensional indices to a simple offset, the dot product of the indices and `strides`.
+			Bounds checked against `dims` for debug builds. */
+		template<std::size_t N, typename SizeType = std::size_t>
+		inline SizeType strided_indices_offset
+			([[maybe_unused]] dimensions<N, SizeType> const& dims, dimensions<N, SizeType> const& strides, indices<N, SizeType> const& idx)
+		{
+			#ifdef _DEBUG
+				for (SizeType i = 0; i < N; ++i) {
+					assert(idx[i] < dims[i]);
+				}
+			#endif
+
+			SizeType offset = 0;
+
+			for (std::size_t i = 0; i < N; ++i) {
+				offset += idx[i] * strides[i];
+			}
+
+			return offset;
+		}
+
+		// Gets the strides of a contiguous array of the given dimensions, the last dimension varying fastest.
+		template<std::size_t N, typename SizeType = std::size_t>
+		inline dimensions<N, SizeType> contiguous_strides(dimensions<N, SizeType> const& dims)
+		{
+			dimensions<N, SizeType> strides{};
+			SizeType stride = 1;
+
+			for (std::size_t i = N; i > 0; --i) {
+				strides[i - 1] = stride;
+				stride *= dims[i - 1];
+			}
+
+			return strides;
+		}
+
+		// Extent of a dimension whose size is only known at run time.
+		constexpr inline std::size_t dynamic_extent = static_cast<std::size_t>(-1);
+
+		// Sizes of the dynamic dimensions of extents.
+		template<std::size_t R>
+		struct dynamic_sizes {
+			std::array<std::size_t, R> sizes{};
+		};
+
+		// Sizes of the dynamic dimensions of extents with none, an empty class.
+		template<>
+		struct dynamic_sizes<0> {};
+
+		/* Sizes of the dimensions of an array, each either fixed at compile time or dynamic_extent for a size given at run
+			time (eg extents<dynamic_extent, 3, 3, 64> for a batch of 3x3x64 tensors).
+			Only the dynamic sizes are stored, so extents with no dynamic dimensions are an empty class, and the sizes of
+			static dimensions are constants wherever the dimension is known at compile time. */
+		template<std::size_t... Extents>
+		class extents : private dynamic_sizes<((Extents == dynamic_extent) + ... + 0)> {
+		public:
+
+			/* Member type aliases */
+
+			using size_type = std::size_t;
+
+
+			/* Member constants */
+
+			// Sizes of the dimensions, dynamic_extent for those given at run time.
+			static constexpr std::array<size_type, sizeof...(Extents)> static_extents{Extents...};
+
+
+			/* Special members */
+
+			// Destructor.
+			~extents() = default;
+
+			// Default constructor, dynamic dimensions are zero.
+			constexpr extents() = default;
+
+			// Copy constructor.
+			constexpr extents(extents const&) = default;
+
+			// Move constructor.
+			constexpr extents(extents&&) = default;
+
+			/* Constructor from the sizes of the dynamic dimensions, outermost first.
+				Sizes must be convertible to size_type. */
+			template<typename... Sizes, typename = std::enable_if_t<sizeof...(Sizes) == ((Extents == dynamic_extent) + ... + 0) && (sizeof...(Sizes) > 0)>>
+			constexpr explicit extents(Sizes... sizes)
+			{
+				this->sizes = {static_cast<size_type>(sizes)...};
+			}
+
+			/* Constructor from the sizes of all dimensions.
+				Sizes of static dimensions must match, checked for debug builds. */
+			constexpr explicit extents(dimensions<sizeof...(Extents), size_type> const& dims)
+			{
+				for (size_type d = 0; d < rank(); ++d) {
+					if (static_extents[d] == dynamic_extent) {
+						if constexpr (rank_dynamic() > 0) {
+							this->sizes[dynamic_index(d)] = dims[d];
+						}
+					}
+					#ifdef _DEBUG
+						else {
+							assert(dims[d] == static_extents[d]);
+						}
+					#endif
+				}
+			}
+
+
+			/* Operators */
+
+			// Simple assignment - copy.
+			constexpr extents& operator=(extents const&) = default;
+
+			// Simple assignment - move.
+			constexpr extents& operator=(extents&&) = default;
+
+
+			/* General member functions */
+
+			// Gets the index, among the dynamic dimensions, of dimension `d`, ie the number of dynamic dimensions before it.
+			static constexpr size_type dynamic_index(size_type d)
+			{
+				size_type index = 0;
+
+				for (size_type i = 0; i < d; ++i) {
+					index += static_extents[i] == dynamic_extent;
+				}
+
+				return index;
+			}
+
+			/* Size of the specified dimension (zero-indexed).
+				A constant when `d` is known at compile time and the dimension is static. */
+			constexpr size_type extent(size_type d) const
+			{
+				if constexpr (rank_dynamic() == 0) {
+					return static_extents[d];
+				}
+				else {
+					return static_extents[d] != dynamic_extent ? static_extents[d] : this->sizes[dynamic_index(d)];
+				}
+			}
+
+			// Number of dimensions.
+			static constexpr size_type rank()
+			{
+				return sizeof...(Extents);
+			}
+
+			// Number of dynamic dimensions.
+			static constexpr size_type rank_dynamic()
+			{
+				return ((Extents == dynamic_extent) + ... + 0);
+			}
+
+			// Size of the specified dimension (zero-indexed) if it is static, otherwise dynamic_extent.
+			static constexpr size_type static_extent(size_type d)
+			{
+				return static_extents[d];
+			}
+		};
+
 		/* Non-owning view of an N-dimensional array.
-			Efficient element access specialisations for N == 1, 2, 3, 4.
-			N == 0 is dynamic dimensionality. */
-		template<typename T, std::size_t N>
+			Each dimension has a stride, the number of elements between consecutive indices of that dimension, so a view can
+			be a slice, a sub-box or a permutation of the axes of a bigger array without copying. The strides default to those
+			of a contiguous array, the last dimension varying fastest.
+			Element access is the dot product of the indices and the strides, which are computed once on construction.
+			Indices are 0-indexed.
+			N == 0 is dynamic dimensionality.
+			`Extents` is void for dimensions given at run time, or tc::array_view::extents for dimensions fixed at compile
+			time (see the specialisation below). */
+		template<typename T, std::size_t N, typename Extents = void>
 		class array_view {
 		public:
 
@@ -153,7 +323,8 @@ namespace tc {
 
 			// Default constructor.
 			array_view() :
-				_dims{}
+				_dims{},
+				_strides{}
 			{}
 
 			// Copy constructor.
@@ -170,13 +341,22 @@ namespace tc {
 				Dimensions... dimensions
 			) :
 				_view{array},
-				_dims{static_cast<size_type>(dimensions)...}
+				_dims{static_cast<size_type>(dimensions)...},
+				_strides{contiguous_strides<N, size_type>(_dims)}
 			{}
 
 			// Constructor from pointer to array and dimensions type.
 			array_view(pointer array, dimensions<N, size_type> const& dimensions) :
 				_view{array},
-				_dims{dimensions}
+				_dims{dimensions},
+				_strides{contiguous_strides<N, size_type>(dimensions)}
+			{}
+
+			// Constructor from pointer to array, dimensions type and strides, in elements, of each dimension.
+			array_view(pointer array, dimensions<N, size_type> const& dimensions, tc::array_view::dimensions<N, size_type> const& strides) :
+				_view{array},
+				_dims{dimensions},
+				_strides{strides}
 			{}
 
 
@@ -190,7 +370,7 @@ namespace tc {
 
 			/* Subscript - dimension access.
 				Same as operator() for N == 1.
-				Otherwise, returns the specified dimension as a new array_view. 
+				Otherwise, returns the specified index of the outermost dimension as a new array_view, ie slice(0, index).
 				Bounds checked for debug builds. */
 			std::conditional_t<N == 1, reference, array_view<T, N - 1>> operator[](size_type index) const
 			{
@@ -198,31 +378,18 @@ namespace tc {
 					return operator()(index);
 				}
 				else {
-					#ifdef _DEBUG
-						assert(index < _dims[0]);
-					#endif
-					
-					size_type dim0_size = 1;
-
-					for (size_type i = N - 1; i > 0; --i) {
-						dim0_size *= _dims[i];
-					}
-
-					pointer new_pointer = _view.data() + (dim0_size * index);
-
-					dimensions<N - 1, size_type> new_dims{};
-					std::copy(_dims.cbegin() + 1, _dims.cend(), new_dims.begin());
-
-					return {new_pointer, new_dims};
+					return slice(0, index);
 				}
 			}
 
 			/* Function call - element access.
-				Uses array_view<T, 0>::operator().*/
+				Uses strided_indices_offset with the precomputed strides. */
 			template<typename... Indices>
 			inline reference operator()(Indices... idx) const
 			{
-				return _view(_dims, idx...);
+				static_assert(sizeof...(Indices) == N, "one index per dimension");
+
+				return _view.data()[strided_indices_offset<N, size_type>(_dims, _strides, {static_cast<size_type>(idx)...})];
 			}
 
 
@@ -245,6 +412,51 @@ namespace tc {
 				return _dims[d];
 			}
 
+			// Sizes of all dimensions.
+			dimensions<N, size_type> const& dim_sizes() const
+			{
+				return _dims;
+			}
+
+			// Checks whether the viewed elements are contiguous, with the last dimension varying fastest.
+			bool is_contiguous() const
+			{
+				size_type stride = 1;
+
+				for (size_type i = N; i > 0; --i) {
+					if (_dims[i - 1] != 1 && _strides[i - 1] != stride) {
+						return false;
+					}
+					stride *= _dims[i - 1];
+				}
+
+				return true;
+			}
+
+			/* Gets a view of the same elements with the axes reordered, axis i of the view being axis `axes[i]` of this.
+				`axes` must be a permutation of [0, N), checked for debug builds. */
+			array_view permuted(indices<N, size_type> const& axes) const
+			{
+				dimensions<N, size_type> new_dims{};
+				dimensions<N, size_type> new_strides{};
+
+				#ifdef _DEBUG
+					std::array<bool, N> seen{};
+				#endif
+
+				for (size_type i = 0; i < N; ++i) {
+					#ifdef _DEBUG
+						assert(axes[i] < N && !seen[axes[i]]);
+						seen[axes[i]] = true;
+					#endif
+
+					new_dims[i] = _dims[axes[i]];
+					new_strides[i] = _strides[axes[i]];
+				}
+
+				return {_view.data(), new_dims, new_strides};
+			}
+
 			// Total number of viewed elements.
 			size_type size() const
 			{
@@ -257,6 +469,66 @@ namespace tc {
 				return s;
 			}
 
+			/* Gets a view of one index of the specified dimension, with that dimension removed.
+				Bounds checked for debug builds. */
+			template<std::size_t M = N>
+			std::enable_if_t<(M > 1), array_view<T, M - 1>> slice(size_type axis, size_type index) const
+			{
+				#ifdef _DEBUG
+					assert(axis < N);
+					assert(index < _dims[axis]);
+				#endif
+
+				dimensions<N - 1, size_type> new_dims{};
+				dimensions<N - 1, size_type> new_strides{};
+
+				for (size_type i = 0, j = 0; i < N; ++i) {
+					if (i != axis) {
+						new_dims[j] = _dims[i];
+						new_strides[j] = _strides[i];
+						++j;
+					}
+				}
+
+				return {_view.data() + index * _strides[axis], new_dims, new_strides};
+			}
+
+			/* Stride of the specified dimension (zero-indexed), the number of elements between consecutive indices.
+				Bounds checked for debug builds. */
+			size_type stride(size_type d) const
+			{
+				#ifdef _DEBUG
+					assert(d < N);
+				#endif
+
+				return _strides[d];
+			}
+
+			// Strides of all dimensions.
+			dimensions<N, size_type> const& strides() const
+			{
+				return _strides;
+			}
+
+			/* Gets a view of the box of `extent` elements in each dimension starting at indices `begin`.
+				Bounds checked for debug builds. */
+			array_view subview(indices<N, size_type> const& begin, dimensions<N, size_type> const& extent) const
+			{
+				#ifdef _DEBUG
+					for (size_type i = 0; i < N; ++i) {
+						assert(begin[i] + extent[i] <= _dims[i]);
+					}
+				#endif
+
+				size_type offset = 0;
+
+				for (size_type i = 0; i < N; ++i) {
+					offset += begin[i] * _strides[i];
+				}
+
+				return {_view.data() + offset, extent, _strides};
+			}
+
 
 		private:
 
@@ -267,6 +539,9 @@ namespace tc {
 
 			// Dimensions of the view, from outermost to innermost.
 			dimensions<N, size_type> _dims;
+
+			// Number of elements between consecutive indices of each dimension.
+			dimensions<N, size_type> _strides;
 		};
 
 		// array_view specialisation for N == 0 - dynamic dimensions.
@@ -343,10 +618,262 @@ namespace tc {
 			pointer _data;
 		};
 
+		/* array_view specialisation for extents fixed at compile time, any of which may be dynamic_extent.
+			The array is contiguous, the last dimension varying fastest, and only the pointer and the dynamic sizes are
+			stored, so a view with no dynamic dimensions is the size of a pointer. The stride of each dimension is a constant
+			when the dimensions after it are static, so offsets fold into constants and loops over the inner dimensions can
+			be unrolled and vectorised.
+			Slices, subviews and permutations are strided, returned as array_view<T, N>, to which this converts. */
+		template<typename T, std::size_t N, std::size_t Extent0, std::size_t... Extents>
+		class array_view<T, N, extents<Extent0, Extents...>> : private extents<Extent0, Extents...> {
+		public:
+
+			static_assert(N == 1 + sizeof...(Extents), "one extent per dimension");
+
+			/* Member type aliases */
+
+			using element_type = T;
+			using value_type = std::remove_cv_t<element_type>;
+			using size_type = std::size_t;
+			using reference = element_type&;
+			using const_reference = element_type const&;
+			using pointer = element_type*;
+			using const_pointer = element_type const*;
+			using difference_type = typename std::pointer_traits<pointer>::difference_type;
+			using extents_type = extents<Extent0, Extents...>;
+
+
+			/* Member constants */
+
+			// Strides of the dimensions, dynamic_extent for those that depend on a dynamic dimension.
+			static constexpr dimensions<N, size_type> static_strides = []() {
+				dimensions<N, size_type> strides{};
+				size_type stride = 1;
+
+				for (size_type i = N; i > 0; --i) {
+					strides[i - 1] = stride;
+
+					if (stride != dynamic_extent) {
+						stride = extents_type::static_extent(i - 1) == dynamic_extent ? dynamic_extent : stride * extents_type::static_extent(i - 1);
+					}
+				}
+
+				return strides;
+			}();
+
+
+			/* Special members */
+
+			// Destructor.
+			~array_view() = default;
+
+			// Default constructor.
+			array_view() :
+				extents_type{},
+				_data{nullptr}
+			{}
+
+			// Copy constructor.
+			array_view(array_view const&) = default;
+
+			// Move constructor.
+			array_view(array_view&&) = default;
+
+			/* Constructor from pointer to array and sizes of the dynamic dimensions, outermost first.
+				Sizes must be convertible to size_type. */
+			template<typename... Sizes, typename = std::enable_if_t<sizeof...(Sizes) == extents_type::rank_dynamic()>>
+			explicit array_view(pointer array, Sizes... sizes) :
+				extents_type{static_cast<size_type>(sizes)...},
+				_data{array}
+			{}
+
+			// Constructor from pointer to array and extents.
+			array_view(pointer array, extents_type const& extents) :
+				extents_type{extents},
+				_data{array}
+			{}
+
+
+			/* Operators */
+
+			// Simple assignment - copy.
+			array_view& operator=(array_view const&) = default;
+
+			// Simple assignment - move.
+			array_view& operator=(array_view&&) = default;
+
+			/* Subscript - dimension access.
+				Same as operator() for N == 1.
+				Otherwise, returns the specified index of the outermost dimension as a contiguous view of the remaining extents.
+				Bounds checked for debug builds. */
+			decltype(auto) operator[](size_type index) const
+			{
+				if constexpr (N == 1) {
+					return operator()(index);
+				}
+				else {
+					#ifdef _DEBUG
+						assert(index < dim_size(0));
+					#endif
+
+					dimensions<N - 1, size_type> new_dims{};
+
+					for (size_type i = 1; i < N; ++i) {
+						new_dims[i - 1] = dim_size(i);
+					}
+
+					return array_view<T, N - 1, extents<Extents...>>{_data + index * stride(0), extents<Extents...>{new_dims}};
+				}
+			}
+
+			/* Function call - element access.
+				The dot product of the indices and the strides, unrolled over the dimensions.
+				Bounds checked for debug builds. */
+			template<typename... Indices>
+			inline reference operator()(Indices... idx) const
+			{
+				static_assert(sizeof...(Indices) == N, "one index per dimension");
+
+				indices<N, size_type> const idx_arg{static_cast<size_type>(idx)...};
+
+				#ifdef _DEBUG
+					for (size_type i = 0; i < N; ++i) {
+						assert(idx_arg[i] < dim_size(i));
+					}
+				#endif
+
+				return _data[offset(idx_arg, std::make_index_sequence<N>{})];
+			}
+
+			// Conversion to a strided view of the same elements.
+			operator array_view<T, N>() const
+			{
+				return {_data, dim_sizes(), strides()};
+			}
+
+
+			/* General member functions */
+
+			// Pointer to array.
+			pointer data() const
+			{
+				return _data;
+			}
+
+			/* Size of the specified dimension (zero-indexed).
+				A constant when `d` is known at compile time and the dimension is static.
+				Bounds checked for debug builds. */
+			size_type dim_size(size_type d) const
+			{
+				#ifdef _DEBUG
+					assert(d < N);
+				#endif
+
+				return extents_type::extent(d);
+			}
+
+			// Sizes of all dimensions.
+			dimensions<N, size_type> dim_sizes() const
+			{
+				dimensions<N, size_type> dims{};
+
+				for (size_type i = 0; i < N; ++i) {
+					dims[i] = dim_size(i);
+				}
+
+				return dims;
+			}
+
+			// Checks whether the viewed elements are contiguous, always true.
+			static constexpr bool is_contiguous()
+			{
+				return true;
+			}
+
+			// Gets a strided view of the same elements with the axes reordered, see array_view<T, N>::permuted.
+			array_view<T, N> permuted(indices<N, size_type> const& axes) const
+			{
+				return static_cast<array_view<T, N>>(*this).permuted(axes);
+			}
+
+			// Total number of viewed elements.
+			size_type size() const
+			{
+				size_type s = 1;
+
+				for (size_type i = 0; i < N; ++i) {
+					s *= dim_size(i);
+				}
+
+				return s;
+			}
+
+			// Gets a strided view of one index of the specified dimension, see array_view<T, N>::slice.
+			template<std::size_t M = N>
+			std::enable_if_t<(M > 1), array_view<T, M - 1>> slice(size_type axis, size_type index) const
+			{
+				return static_cast<array_view<T, N>>(*this).slice(axis, index);
+			}
+
+			/* Stride of the specified dimension (zero-indexed), the number of elements between consecutive indices.
+				A constant when `d` is known at compile time and the dimensions after it are static.
+				Bounds checked for debug builds. */
+			size_type stride(size_type d) const
+			{
+				#ifdef _DEBUG
+					assert(d < N);
+				#endif
+
+				if (static_strides[d] != dynamic_extent) {
+					return static_strides[d];
+				}
+
+				size_type s = 1;
+
+				for (size_type i = d + 1; i < N; ++i) {
+					s *= dim_size(i);
+				}
+
+				return s;
+			}
+
+			// Strides of all dimensions.
+			dimensions<N, size_type> strides() const
+			{
+				return contiguous_strides<N, size_type>(dim_sizes());
+			}
+
+			// Gets a strided view of the box of `extent` elements in each dimension starting at indices `begin`.
+			array_view<T, N> subview(indices<N, size_type> const& begin, dimensions<N, size_type> const& extent) const
+			{
+				return static_cast<array_view<T, N>>(*this).subview(begin, extent);
+			}
+
+
+		private:
+
+			// Offset of the element at `idx`, the sum of each index times its stride.
+			template<std::size_t... I>
+			size_type offset(indices<N, size_type> const& idx, std::index_sequence<I...>) const
+			{
+				return ((idx[I] * stride(I)) + ...);
+			}
+
+
+			/* Member variables */
+
+			// Pointer to the start of the viewed array.
+			pointer _data;
+		};
+
 		// Dynamic dimension array_view.
 		template<typename T>
 		using array_view_dyn = array_view<T, 0>;
 
+		// array_view with extents fixed at compile time, any of which may be dynamic_extent.
+		template<typename T, std::size_t... Extents>
+		using array_view_static = array_view<T, sizeof...(Extents), extents<Extents...>>;
+
 		// 1D array_view.
 		template<typename T>
 		using array_view1d = array_view<T, 1>;
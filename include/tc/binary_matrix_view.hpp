@@ -0,0 +1,197 @@
+#pragma once
+
+#ifdef _DEBUG
+	#include <cassert>			// assert
+#endif
+#include <cstddef>				// std::size_t
+#include <cstdint>				// std::uint64_t
+#include <type_traits>			// std::is_same_v, std::remove_cv_t
+#include "binary_util.hpp"		// tc::binary_util::bits, tc::binary_util::get_bit
+
+
+namespace tc {
+	namespace binary_matrix_view {
+
+		/* Non-owning view of an array of 64 bit words as a matrix of bits, row major.
+			Each row is packed into `stride` consecutive words, column j of a row is bit (j - 1) % 64 of word (j - 1) / 64.
+			The stride defaults to row_words(columns), ie a contiguous matrix. Bits past the last column of each row must be
+			zero, so that whole words can be counted.
+			`Word` is std::uint64_t, or std::uint64_t const for a read-only view.
+			Element access is 1-indexed. */
+		template<typename Word = std::uint64_t>
+		class binary_matrix_view {
+		public:
+
+			static_assert(std::is_same_v<std::remove_cv_t<Word>, std::uint64_t>, "bits are packed into 64 bit words");
+
+			/* Member type aliases */
+
+			using word_type = Word;
+			using size_type = std::size_t;
+			using pointer = word_type*;
+
+
+			/* Member constants */
+
+			// Number of bits in a word.
+			static constexpr size_type word_bits = tc::binary_util::bits<std::uint64_t>;
+
+
+			/* Special members */
+
+			// Destructor.
+			~binary_matrix_view() = default;
+
+			// Default constructor.
+			binary_matrix_view() :
+				_data{nullptr},
+				_rows{0},
+				_columns{0},
+				_stride{0}
+			{}
+
+			// Copy constructor.
+			binary_matrix_view(binary_matrix_view const&) = default;
+
+			// Move constructor.
+			binary_matrix_view(binary_matrix_view&&) = default;
+
+			// Constructor from pointer to array of words and dimensions in bits.
+			binary_matrix_view(pointer data, size_type rows, size_type columns) :
+				_data{data},
+				_rows{rows},
+				_columns{columns},
+				_stride{row_words(columns)}
+			{}
+
+			/* Constructor from pointer to array of words, dimensions in bits and stride in words.
+				`stride` must be at least row_words(columns). */
+			binary_matrix_view(pointer data, size_type rows, size_type columns, size_type stride) :
+				_data{data},
+				_rows{rows},
+				_columns{columns},
+				_stride{stride}
+			{
+				#ifdef _DEBUG
+					assert(stride >= row_words(columns));
+				#endif
+			}
+
+
+			/* Operators */
+
+			// Simple assignment - copy.
+			binary_matrix_view& operator=(binary_matrix_view const&) = default;
+
+			// Simple assignment - move.
+			binary_matrix_view& operator=(binary_matrix_view&&) = default;
+
+			/* Function call - gets the bit at (`row`, `column`).
+				Bounds checked for debug builds. */
+			bool operator()(size_type row, size_type column) const
+			{
+				#ifdef _DEBUG
+					assert(row > 0 && row <= _rows);
+					assert(column > 0 && column <= _columns);
+				#endif
+
+				return tc::binary_util::get_bit(row_data(row)[(column - 1) / word_bits], (column - 1) % word_bits);
+			}
+
+			// Conversion to a read-only view.
+			operator binary_matrix_view<word_type const>() const
+			{
+				return {_data, _rows, _columns, _stride};
+			}
+
+
+			/* General member functions */
+
+			// Gets the number of columns (bits per row) viewed.
+			size_type columns() const
+			{
+				return _columns;
+			}
+
+			// Gets the pointer to the first word.
+			pointer data() const
+			{
+				return _data;
+			}
+
+			// Checks whether the rows are contiguous, ie whether there are no unused words between rows.
+			bool is_contiguous() const
+			{
+				return _stride == row_words(_columns);
+			}
+
+			/* Gets the pointer to the first word of the specified row.
+				Bounds checked for debug builds. */
+			pointer row_data(size_type row) const
+			{
+				#ifdef _DEBUG
+					assert(row > 0 && row <= _rows);
+				#endif
+
+				return _data + (row - 1) * _stride;
+			}
+
+			// Gets the number of words needed to pack a row of `columns` bits.
+			static constexpr size_type row_words(size_type columns)
+			{
+				return (columns + word_bits - 1) / word_bits;
+			}
+
+			// Gets the number of rows viewed.
+			size_type rows() const
+			{
+				return _rows;
+			}
+
+			/* Sets the bit at (`row`, `column`) to `value`.
+				Bounds checked for debug builds. */
+			void set(size_type row, size_type column, bool value) const
+			{
+				#ifdef _DEBUG
+					assert(row > 0 && row <= _rows);
+					assert(column > 0 && column <= _columns);
+				#endif
+
+				word_type& word = row_data(row)[(column - 1) / word_bits];
+				std::uint64_t const mask = std::uint64_t{1} << ((column - 1) % word_bits);
+
+				word = value ? word | mask : word & ~mask;
+			}
+
+			// Gets the total number of bits viewed.
+			size_type size() const
+			{
+				return _rows * _columns;
+			}
+
+			// Gets the number of words between the starts of consecutive rows.
+			size_type stride() const
+			{
+				return _stride;
+			}
+
+
+		private:
+
+			/* Member variables */
+
+			// Pointer to the first word.
+			pointer _data;
+
+			// Number of rows.
+			size_type _rows;
+
+			// Number of columns (bits per row).
+			size_type _columns;
+
+			// Number of words between the starts of consecutive rows.
+			size_type _stride;
+		};
+
+	}
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <algorithm>				// std::max, std::min
+#ifdef _DEBUG
+	#include <cassert>				// assert
+#endif
+#include <cstddef>					// std::size_t
+#include <cstdint>					// std::uint64_t
+#include "binary_matrix_view.hpp"	// tc::binary_matrix_view::binary_matrix_view
+#include "binary_util.hpp"			// tc::binary_util::popcount_xor, tc::binary_util::set_bit_cond
+#include "parallel.hpp"				// tc::parallel::chunk_size, tc::parallel::for_each_chunk
+
+
+namespace tc {
+	namespace binary_ops {
+
+		/* Binarisation and products of bit matrices.
+			A bit matrix (tc::binary_matrix_view::binary_matrix_view) stands for a matrix of +1 and -1 elements, a set bit
+			being +1. Rows are packed into 64 bit words, 32 times smaller than float and 64 times smaller than double. */
+
+		/* Packs the signs of `input` into `result`, a set bit for each element >= 0 (+1) and a clear bit for each
+			negative (or NaN) element (-1). Bits past the last column of each row are cleared.
+			`input` may have any layout. Rows are split across threads. */
+		template<typename SizeType = std::size_t, class InputMatrix>
+		void pack_sign(InputMatrix const& input, tc::binary_matrix_view::binary_matrix_view<std::uint64_t>& result)
+		{
+			#ifdef _DEBUG
+				assert(input.rows() == result.rows());
+				assert(input.columns() == result.columns());
+			#endif
+
+			using value_type = typename InputMatrix::value_type;
+
+			constexpr std::size_t word_bits = tc::binary_matrix_view::binary_matrix_view<std::uint64_t>::word_bits;
+
+			std::size_t const columns = input.columns();
+			std::size_t const words = result.row_words(columns);
+			std::size_t const rows_per_chunk = std::max<std::size_t>(tc::parallel::chunk_size / std::max<std::size_t>(columns, 1), 1);
+
+			tc::parallel::for_each_chunk(input.rows(), [&](std::size_t begin, std::size_t end) {
+				for (SizeType i = begin + 1; i <= end; ++i) {
+					std::uint64_t* const row = result.row_data(i);
+
+					for (std::size_t w = 0; w < words; ++w) {
+						std::size_t const bits = std::min(word_bits, columns - w * word_bits);
+						std::uint64_t word = 0;
+
+						for (std::size_t b = 0; b < bits; ++b) {
+							tc::binary_util::set_bit_cond(word, b, input(i, w * word_bits + b + 1) >= value_type{});
+						}
+						row[w] = word;
+					}
+				}
+			}, rows_per_chunk);
+		}
+
+		/* Unpacks `input` into `result`, +1 for each set bit and -1 for each clear bit.
+			Rows are split across threads. */
+		template<typename SizeType = std::size_t, typename Word, class OutputMatrix>
+		void unpack_sign(tc::binary_matrix_view::binary_matrix_view<Word> const& input, OutputMatrix& result)
+		{
+			#ifdef _DEBUG
+				assert(input.rows() == result.rows());
+				assert(input.columns() == result.columns());
+			#endif
+
+			using value_type = typename OutputMatrix::value_type;
+
+			std::size_t const columns = input.columns();
+			std::size_t const rows_per_chunk = std::max<std::size_t>(tc::parallel::chunk_size / std::max<std::size_t>(columns, 1), 1);
+
+			tc::parallel::for_each_chunk(input.rows(), [&](std::size_t begin, std::size_t end) {
+				for (SizeType i = begin + 1; i <= end; ++i) {
+					for (SizeType j = 1; j <= columns; ++j) {
+						result(i, j) = input(i, j) ? value_type{1} : value_type{-1};
+					}
+				}
+			}, rows_per_chunk);
+		}
+
+		/* Binary matrix multiplication, result = lhs rhs^T for matrices of +1 and -1 elements.
+			Row i of `lhs` and row j of `rhs` are k element vectors (k = columns), and result(i, j) is their dot product,
+			k - 2 popcount(lhs_i XOR rhs_j), ie twice the popcount of their XNOR less k. So `rhs` holds the right-hand
+			operand by columns, as pack_sign of its transpose gives, or the vectors to compare against in a similarity search.
+			Rows of `lhs` are split across threads, and `rhs` is walked in blocks that stay in L1 cache while each row of the
+			chunk is compared against them. */
+		template<typename SizeType = std::size_t, typename Word1, typename Word2, class OutputMatrix>
+		void binary_mm_mul(tc::binary_matrix_view::binary_matrix_view<Word1> const& lhs, tc::binary_matrix_view::binary_matrix_view<Word2> const& rhs, OutputMatrix& result)
+		{
+			#ifdef _DEBUG
+				assert(lhs.columns() == rhs.columns());
+				assert(lhs.rows() == result.rows());
+				assert(rhs.rows() == result.columns());
+			#endif
+
+			using value_type = typename OutputMatrix::value_type;
+
+			std::size_t const k = lhs.columns();
+			std::size_t const words = lhs.row_words(k);
+			std::size_t const m = rhs.rows();
+
+			// Rows of rhs per block, 16 KiB of words.
+			std::size_t const block = std::max<std::size_t>((std::size_t{1} << 14) / (8 * std::max<std::size_t>(words, 1)), 1);
+			std::size_t const rows_per_chunk = std::max<std::size_t>(tc::parallel::chunk_size / std::max<std::size_t>(m * words, 1), 1);
+
+			tc::parallel::for_each_chunk(lhs.rows(), [&](std::size_t begin, std::size_t end) {
+				for (std::size_t jb = 0; jb < m; jb += block) {
+					std::size_t const je = std::min(jb + block, m);
+
+					for (SizeType i = begin + 1; i <= end; ++i) {
+						auto const a = lhs.row_data(i);
+
+						for (SizeType j = jb + 1; j <= je; ++j) {
+							std::size_t const differences = tc::binary_util::popcount_xor(a, rhs.row_data(j), words);
+
+							result(i, j) = static_cast<value_type>(static_cast<std::ptrdiff_t>(k) - 2 * static_cast<std::ptrdiff_t>(differences));
+						}
+					}
+				}
+			}, rows_per_chunk);
+		}
+
+	}
+}
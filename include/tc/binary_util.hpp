@@ -3,7 +3,12 @@
 #include <climits>			// CHAR_BIT
 #include <cstddef>			// std::size_t
 #include <cstdint>			// std::uint16_t, std::uint32_t, std::uint64_t
-#include <intrin.h>			// __popcount16, __popcount, __popcount64
+#if defined(_MSC_VER) && !defined(__clang__)
+	#include <intrin.h>		// __popcnt16, __popcnt, __popcnt64
+#endif
+#if defined(__AVX2__) || defined(__AVX512VPOPCNTDQ__)
+	#include <immintrin.h>	// _mm256_*, _mm512_*
+#endif
 #include <type_traits>		// std::enable_if_t
 
 
@@ -21,25 +26,53 @@ namespace tc {
 			return (value >> n) & static_cast<T>(1U);
 		}
 		
+		/* Popcount (number of bits set) of a 64 bit word without hardware support.
+			Counts bits in parallel within 2, 4 and 8 bit fields, then sums the bytes with a multiply. */
+		inline std::size_t popcount_swar(std::uint64_t val)
+		{
+			val = val - ((val >> 1) & 0x5555555555555555u);
+			val = (val & 0x3333333333333333u) + ((val >> 2) & 0x3333333333333333u);
+			val = (val + (val >> 4)) & 0x0F0F0F0F0F0F0F0Fu;
+			return static_cast<std::size_t>((val * 0x0101010101010101u) >> 56);
+		}
+		
 		// Popcount (number of bits set) (<=16 bit type).
 		template<typename T>
 		inline std::enable_if_t<(bits<T> <= 16), std::size_t> popcount(T const& val)
 		{
-			return __popcnt16(static_cast<std::uint16_t>(val));
+			#if defined(_MSC_VER) && !defined(__clang__)
+				return __popcnt16(static_cast<std::uint16_t>(val));
+			#elif defined(__GNUC__)
+				return static_cast<std::size_t>(__builtin_popcount(static_cast<std::uint16_t>(val)));
+			#else
+				return popcount_swar(static_cast<std::uint16_t>(val));
+			#endif
 		}
 
 		// Popcount (number of bits set) (17-32 bit type).
 		template<typename T>
 		inline std::enable_if_t<(bits<T> > 16) && (bits<T> <= 32), std::size_t> popcount(T const& val)
 		{
-			return __popcnt(static_cast<std::uint32_t>(val));
+			#if defined(_MSC_VER) && !defined(__clang__)
+				return __popcnt(static_cast<std::uint32_t>(val));
+			#elif defined(__GNUC__)
+				return static_cast<std::size_t>(__builtin_popcount(static_cast<std::uint32_t>(val)));
+			#else
+				return popcount_swar(static_cast<std::uint32_t>(val));
+			#endif
 		}
 
 		// Popcount (number of bits set) (33-64 bit type).
 		template<typename T>
 		inline std::enable_if_t<(bits<T> > 32) && (bits<T> <= 64), std::size_t> popcount(T const& val)
 		{
-			return __popcnt64(static_cast<std::uint64_t>(val));
+			#if defined(_MSC_VER) && !defined(__clang__)
+				return static_cast<std::size_t>(__popcnt64(static_cast<std::uint64_t>(val)));
+			#elif defined(__GNUC__)
+				return static_cast<std::size_t>(__builtin_popcountll(static_cast<std::uint64_t>(val)));
+			#else
+				return popcount_swar(static_cast<std::uint64_t>(val));
+			#endif
 		}
 		
 		// Conditionally set the nth bit to 1 (bit 0 is LSB).
@@ -48,6 +81,257 @@ namespace tc {
 		{
 			val |= static_cast<T>(condition) << n;
 		}
+		
+		
+		/* Bulk popcounts.
+			Each counts the bits set in n 64 bit words, of one array or of two arrays combined word by word, in one pass.
+			With AVX-512 VPOPCNTDQ the words are counted eight at a time by vpopcntq, into four independent sums. With AVX2 they are counted by the
+			Harley-Seal method: sixteen 256 bit vectors are reduced by carry-save adders to one vector of sixteens plus
+			vectors of eights, fours, twos and ones, so only one vector in sixteen has its bits counted (by nibble lookup).
+			Otherwise each word is counted by popcount, into four independent sums. */
+		
+		// Gets word i of an array.
+		struct load_word {
+			std::uint64_t const* a;
+			
+			std::uint64_t operator()(std::size_t i) const
+			{
+				return a[i];
+			}
+			
+			#if defined(__AVX2__)
+				__m256i load256(std::size_t i) const
+				{
+					return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));
+				}
+			#endif
+			
+			#if defined(__AVX512VPOPCNTDQ__)
+				__m512i load512(std::size_t i) const
+				{
+					return _mm512_loadu_si512(a + i);
+				}
+			#endif
+		};
+		
+		// Gets the AND of word i of two arrays.
+		struct load_and {
+			std::uint64_t const* a;
+			std::uint64_t const* b;
+			
+			std::uint64_t operator()(std::size_t i) const
+			{
+				return a[i] & b[i];
+			}
+			
+			#if defined(__AVX2__)
+				__m256i load256(std::size_t i) const
+				{
+					return _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i)), _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i)));
+				}
+			#endif
+			
+			#if defined(__AVX512VPOPCNTDQ__)
+				__m512i load512(std::size_t i) const
+				{
+					return _mm512_and_si512(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i));
+				}
+			#endif
+		};
+		
+		// Gets the OR of word i of two arrays.
+		struct load_or {
+			std::uint64_t const* a;
+			std::uint64_t const* b;
+			
+			std::uint64_t operator()(std::size_t i) const
+			{
+				return a[i] | b[i];
+			}
+			
+			#if defined(__AVX2__)
+				__m256i load256(std::size_t i) const
+				{
+					return _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i)), _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i)));
+				}
+			#endif
+			
+			#if defined(__AVX512VPOPCNTDQ__)
+				__m512i load512(std::size_t i) const
+				{
+					return _mm512_or_si512(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i));
+				}
+			#endif
+		};
+		
+		// Gets the XOR of word i of two arrays.
+		struct load_xor {
+			std::uint64_t const* a;
+			std::uint64_t const* b;
+			
+			std::uint64_t operator()(std::size_t i) const
+			{
+				return a[i] ^ b[i];
+			}
+			
+			#if defined(__AVX2__)
+				__m256i load256(std::size_t i) const
+				{
+					return _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i)), _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i)));
+				}
+			#endif
+			
+			#if defined(__AVX512VPOPCNTDQ__)
+				__m512i load512(std::size_t i) const
+				{
+					return _mm512_xor_si512(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i));
+				}
+			#endif
+		};
+		
+		#if defined(__AVX2__)
+			// Carry-save adder, sets `high` to the carries and `low` to the sums of the bits of a, b and c.
+			inline void carry_save_add(__m256i& high, __m256i& low, __m256i a, __m256i b, __m256i c)
+			{
+				__m256i const u = _mm256_xor_si256(a, b);
+				
+				high = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(u, c));
+				low = _mm256_xor_si256(u, c);
+			}
+			
+			// Popcount of each 64 bit lane of a vector, by looking up the count of each nibble.
+			inline __m256i popcount256(__m256i v)
+			{
+				__m256i const lookup = _mm256_setr_epi8(
+					0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+					0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+				__m256i const low_mask = _mm256_set1_epi8(0x0F);
+				__m256i const low = _mm256_and_si256(v, low_mask);
+				__m256i const high = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+				__m256i const counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, low), _mm256_shuffle_epi8(lookup, high));
+				
+				return _mm256_sad_epu8(counts, _mm256_setzero_si256());
+			}
+			
+			// Sum of the four 64 bit lanes of a vector.
+			inline std::uint64_t sum256(__m256i v)
+			{
+				std::uint64_t lanes[4];
+				
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), v);
+				return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+			}
+		#endif
+		
+		// Popcount of the n words given by load(i) for i in [0, n).
+		template<class Load>
+		std::size_t popcount_words(std::size_t n, Load load)
+		{
+			std::size_t i = 0;
+			std::size_t count = 0;
+			
+			#if defined(__AVX512VPOPCNTDQ__)
+				// Four independent sums hide the latency of vpopcntq.
+				__m512i total0 = _mm512_setzero_si512();
+				__m512i total1 = _mm512_setzero_si512();
+				__m512i total2 = _mm512_setzero_si512();
+				__m512i total3 = _mm512_setzero_si512();
+				
+				for (; i + 32 <= n; i += 32) {
+					total0 = _mm512_add_epi64(total0, _mm512_popcnt_epi64(load.load512(i)));
+					total1 = _mm512_add_epi64(total1, _mm512_popcnt_epi64(load.load512(i + 8)));
+					total2 = _mm512_add_epi64(total2, _mm512_popcnt_epi64(load.load512(i + 16)));
+					total3 = _mm512_add_epi64(total3, _mm512_popcnt_epi64(load.load512(i + 24)));
+				}
+				for (; i + 8 <= n; i += 8) {
+					total0 = _mm512_add_epi64(total0, _mm512_popcnt_epi64(load.load512(i)));
+				}
+				
+				__m512i const total = _mm512_add_epi64(_mm512_add_epi64(total0, total1), _mm512_add_epi64(total2, total3));
+				std::uint64_t lanes[8];
+				
+				_mm512_storeu_si512(lanes, total);
+				for (std::uint64_t lane : lanes) {
+					count += static_cast<std::size_t>(lane);
+				}
+			#elif defined(__AVX2__)
+				__m256i total = _mm256_setzero_si256();
+				__m256i ones = _mm256_setzero_si256();
+				__m256i twos = _mm256_setzero_si256();
+				__m256i fours = _mm256_setzero_si256();
+				__m256i eights = _mm256_setzero_si256();
+				__m256i twos_a, twos_b, fours_a, fours_b, eights_a, eights_b, sixteens;
+				
+				for (; i + 64 <= n; i += 64) {
+					carry_save_add(twos_a, ones, ones, load.load256(i), load.load256(i + 4));
+					carry_save_add(twos_b, ones, ones, load.load256(i + 8), load.load256(i + 12));
+					carry_save_add(fours_a, twos, twos, twos_a, twos_b);
+					carry_save_add(twos_a, ones, ones, load.load256(i + 16), load.load256(i + 20));
+					carry_save_add(twos_b, ones, ones, load.load256(i + 24), load.load256(i + 28));
+					carry_save_add(fours_b, twos, twos, twos_a, twos_b);
+					carry_save_add(eights_a, fours, fours, fours_a, fours_b);
+					carry_save_add(twos_a, ones, ones, load.load256(i + 32), load.load256(i + 36));
+					carry_save_add(twos_b, ones, ones, load.load256(i + 40), load.load256(i + 44));
+					carry_save_add(fours_a, twos, twos, twos_a, twos_b);
+					carry_save_add(twos_a, ones, ones, load.load256(i + 48), load.load256(i + 52));
+					carry_save_add(twos_b, ones, ones, load.load256(i + 56), load.load256(i + 60));
+					carry_save_add(fours_b, twos, twos, twos_a, twos_b);
+					carry_save_add(eights_b, fours, fours, fours_a, fours_b);
+					carry_save_add(sixteens, eights, eights, eights_a, eights_b);
+					total = _mm256_add_epi64(total, popcount256(sixteens));
+				}
+				
+				total = _mm256_slli_epi64(total, 4);
+				total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256(eights), 3));
+				total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256(fours), 2));
+				total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256(twos), 1));
+				total = _mm256_add_epi64(total, popcount256(ones));
+				
+				for (; i + 4 <= n; i += 4) {
+					total = _mm256_add_epi64(total, popcount256(load.load256(i)));
+				}
+				count += static_cast<std::size_t>(sum256(total));
+			#else
+				std::size_t counts[4] = {};
+				
+				for (; i + 4 <= n; i += 4) {
+					counts[0] += popcount(load(i));
+					counts[1] += popcount(load(i + 1));
+					counts[2] += popcount(load(i + 2));
+					counts[3] += popcount(load(i + 3));
+				}
+				count += counts[0] + counts[1] + counts[2] + counts[3];
+			#endif
+			
+			for (; i < n; ++i) {
+				count += popcount(load(i));
+			}
+			return count;
+		}
+		
+		// Popcount (number of bits set) of the `n` words from `a`.
+		inline std::size_t popcount(std::uint64_t const* a, std::size_t n)
+		{
+			return popcount_words(n, load_word{a});
+		}
+		
+		// Popcount of the AND of the `n` words from `a` and from `b`.
+		inline std::size_t popcount_and(std::uint64_t const* a, std::uint64_t const* b, std::size_t n)
+		{
+			return popcount_words(n, load_and{a, b});
+		}
+		
+		// Popcount of the OR of the `n` words from `a` and from `b`.
+		inline std::size_t popcount_or(std::uint64_t const* a, std::uint64_t const* b, std::size_t n)
+		{
+			return popcount_words(n, load_or{a, b});
+		}
+		
+		// Popcount of the XOR of the `n` words from `a` and from `b`, ie the Hamming distance.
+		inline std::size_t popcount_xor(std::uint64_t const* a, std::uint64_t const* b, std::size_t n)
+		{
+			return popcount_words(n, load_xor{a, b});
+		}
 	
 	}
 }
@@ -0,0 +1,221 @@
+#pragma once
+
+#ifdef _DEBUG
+	#include <cassert>			// assert
+#endif
+#include <cstddef>				// std::size_t
+#include <cstdint>				// std::uint64_t
+#include <utility>				// std::exchange, std::move
+#include "aligned.hpp"			// tc::aligned::allocate, tc::aligned::unique_array
+#include "binary_util.hpp"		// tc::binary_util::popcount, tc::binary_util::popcount_and, tc::binary_util::popcount_or, tc::binary_util::popcount_xor
+
+
+namespace tc {
+	namespace bit_vector {
+
+		/* Owning vector of bits, packed into 64 bit words aligned to tc::aligned::alignment bytes.
+			Bit n is bit n % 64 of word n / 64. Bits past the size in the last word are always zero, so whole words can be
+			counted and combined. All bits are zero on construction.
+			Move-only. Bit access is 0-indexed, as for tc::binary_util::get_bit. */
+		class bit_vector {
+		public:
+
+			/* Member type aliases */
+
+			using word_type = std::uint64_t;
+			using size_type = std::size_t;
+
+
+			/* Member constants */
+
+			// Number of bits in a word.
+			static constexpr size_type word_bits = tc::binary_util::bits<word_type>;
+
+
+			/* Special members */
+
+			// Destructor.
+			~bit_vector() = default;
+
+			// Default constructor, an empty bit vector.
+			bit_vector() :
+				_data{},
+				_size{0}
+			{}
+
+			// Copy constructor - deleted, bit vectors are move-only.
+			bit_vector(bit_vector const&) = delete;
+
+			// Move constructor, `other` is left empty.
+			bit_vector(bit_vector&& other) noexcept :
+				_data{std::move(other._data)},
+				_size{std::exchange(other._size, 0)}
+			{}
+
+			// Constructor from number of bits, all bits are zero.
+			explicit bit_vector(size_type size) :
+				_data{tc::aligned::allocate<word_type>((size + word_bits - 1) / word_bits)},
+				_size{size}
+			{}
+
+
+			/* Operators */
+
+			// Simple assignment - copy - deleted, bit vectors are move-only.
+			bit_vector& operator=(bit_vector const&) = delete;
+
+			// Simple assignment - move, `other` is left empty.
+			bit_vector& operator=(bit_vector&& other) noexcept
+			{
+				_data = std::move(other._data);
+				_size = std::exchange(other._size, 0);
+				return *this;
+			}
+
+			/* Bitwise AND assignment, word by word.
+				`other` must have the same size, checked for debug builds. */
+			bit_vector& operator&=(bit_vector const& other)
+			{
+				#ifdef _DEBUG
+					assert(_size == other._size);
+				#endif
+
+				for (size_type i = 0; i < words(); ++i) {
+					_data[i] &= other._data[i];
+				}
+				return *this;
+			}
+
+			/* Bitwise OR assignment, word by word.
+				`other` must have the same size, checked for debug builds. */
+			bit_vector& operator|=(bit_vector const& other)
+			{
+				#ifdef _DEBUG
+					assert(_size == other._size);
+				#endif
+
+				for (size_type i = 0; i < words(); ++i) {
+					_data[i] |= other._data[i];
+				}
+				return *this;
+			}
+
+			/* Bitwise XOR assignment, word by word.
+				`other` must have the same size, checked for debug builds. */
+			bit_vector& operator^=(bit_vector const& other)
+			{
+				#ifdef _DEBUG
+					assert(_size == other._size);
+				#endif
+
+				for (size_type i = 0; i < words(); ++i) {
+					_data[i] ^= other._data[i];
+				}
+				return *this;
+			}
+
+
+			/* General member functions */
+
+			// Gets the number of bits set.
+			size_type count() const
+			{
+				return tc::binary_util::popcount(_data.get(), words());
+			}
+
+			// Gets the pointer to the first word.
+			word_type* data()
+			{
+				return _data.get();
+			}
+
+			// Gets the pointer to the first word.
+			word_type const* data() const
+			{
+				return _data.get();
+			}
+
+			/* Gets the value of the nth bit.
+				Bounds checked for debug builds. */
+			bool get(size_type n) const
+			{
+				#ifdef _DEBUG
+					assert(n < _size);
+				#endif
+
+				return tc::binary_util::get_bit(_data[n / word_bits], n % word_bits);
+			}
+
+			/* Sets the nth bit to `value`.
+				Bounds checked for debug builds. */
+			void set(size_type n, bool value)
+			{
+				#ifdef _DEBUG
+					assert(n < _size);
+				#endif
+
+				word_type& word = _data[n / word_bits];
+				word_type const mask = word_type{1} << (n % word_bits);
+
+				word = value ? word | mask : word & ~mask;
+			}
+
+			// Gets the number of bits.
+			size_type size() const
+			{
+				return _size;
+			}
+
+			// Gets the number of words.
+			size_type words() const
+			{
+				return (_size + word_bits - 1) / word_bits;
+			}
+
+
+		private:
+
+			/* Member variables */
+
+			// Owned, aligned array of words.
+			tc::aligned::unique_array<word_type> _data;
+
+			// Number of bits.
+			size_type _size;
+		};
+
+		/* Number of bits set in both `lhs` and `rhs` (the size of the intersection), in one pass.
+			The bit vectors must have the same size, checked for debug builds. */
+		inline std::size_t and_count(bit_vector const& lhs, bit_vector const& rhs)
+		{
+			#ifdef _DEBUG
+				assert(lhs.size() == rhs.size());
+			#endif
+
+			return tc::binary_util::popcount_and(lhs.data(), rhs.data(), lhs.words());
+		}
+
+		/* Number of bits set in either `lhs` or `rhs` (the size of the union), in one pass.
+			The bit vectors must have the same size, checked for debug builds. */
+		inline std::size_t or_count(bit_vector const& lhs, bit_vector const& rhs)
+		{
+			#ifdef _DEBUG
+				assert(lhs.size() == rhs.size());
+			#endif
+
+			return tc::binary_util::popcount_or(lhs.data(), rhs.data(), lhs.words());
+		}
+
+		/* Number of bits that differ between `lhs` and `rhs` (the Hamming distance), in one pass.
+			The bit vectors must have the same size, checked for debug builds. */
+		inline std::size_t xor_count(bit_vector const& lhs, bit_vector const& rhs)
+		{
+			#ifdef _DEBUG
+				assert(lhs.size() == rhs.size());
+			#endif
+
+			return tc::binary_util::popcount_xor(lhs.data(), rhs.data(), lhs.words());
+		}
+
+	}
+}
@@ -0,0 +1,613 @@
+#pragma once
+
+#include <algorithm>		// std::copy_n, std::fill_n, std::max, std::min
+#include <array>			// std::array
+#ifdef _DEBUG
+	#include <cassert>		// assert
+#endif
+#include <cstddef>			// std::size_t, std::ptrdiff_t
+#include <cstring>			// std::memcpy
+#include <type_traits>		// std::is_same_v, std::remove_cv_t
+#include <utility>			// std::pair
+#include "array_ops.hpp"	// tc::array_ops::a_map
+#include "array_view.hpp"	// tc::array_view::array_view3d, tc::array_view::array_view4d
+#include "gemm.hpp"			// tc::gemm::parallel_gemm, tc::gemm::simd_width
+#include "parallel.hpp"		// tc::parallel::chunk_size, tc::parallel::for_each_chunk
+#include "workspace.hpp"		// tc::workspace::scope
+
+
+namespace tc {
+	namespace conv {
+
+		/* 2-D convolution (cross-correlation, as in neural networks) of NCHW tensors.
+			The input is N x C x H x W, the weights K x C x R x S and the output N x K x P x Q, where
+			P = output_size(H, R, stride_h, padding_h, dilation_h) and likewise Q. Output element (n, k, p, q) is the sum over
+			(c, r, s) of weights(k, c, r, s) input(n, c, p stride_h + r dilation_h - padding_h, q stride_w + s dilation_w -
+			padding_w), positions outside the input being zero.
+			Tensors are array_view4d (or array_views with static extents) of any strides. */
+
+		// Stride, zero padding and dilation of each spatial dimension of a convolution.
+		struct conv2d_options {
+			std::size_t stride_h = 1;
+			std::size_t stride_w = 1;
+			std::size_t padding_h = 0;
+			std::size_t padding_w = 0;
+			std::size_t dilation_h = 1;
+			std::size_t dilation_w = 1;
+		};
+
+		/* Largest number of input channels for which conv2d computes 3 x 3 kernels with conv2d_direct. Past it the product
+			of im2col is large enough for the packed GEMM to run faster. */
+		constexpr inline std::size_t direct_channel_limit = 64;
+
+		// Gets the size of a spatial dimension of the output for input size `size` and kernel size `kernel`.
+		constexpr std::size_t output_size(std::size_t size, std::size_t kernel, std::size_t stride, std::size_t padding, std::size_t dilation)
+		{
+			std::size_t const extent = dilation * (kernel - 1) + 1;
+
+			return size + 2 * padding < extent ? 0 : (size + 2 * padding - extent) / stride + 1;
+		}
+
+		/* Gets the range [first, last) of the `outputs` output positions o whose input position o stride + offset - padding
+			lies in [0, size), offset being the kernel position times the dilation. */
+		inline std::pair<std::size_t, std::size_t> valid_range(std::size_t outputs, std::size_t size, std::size_t stride, std::size_t offset, std::size_t padding)
+		{
+			std::size_t const first = padding > offset ? (padding - offset + stride - 1) / stride : 0;
+			std::size_t const last = size + padding > offset ? (size + padding - offset + stride - 1) / stride : 0;
+
+			return {std::min(first, outputs), std::min(std::max(first, last), outputs)};
+		}
+
+		/* Gets the stride of dimensions [first, 4) of `array` walked as one dimension, or 0 if they cannot be, ie the
+			stride of the columns of `array` taken as a matrix of dimensions [0, first) by [first, 4). */
+		template<class Array>
+		std::size_t merged_stride(Array const& array, std::size_t first)
+		{
+			for (std::size_t d = first; d + 1 < 4; ++d) {
+				if (array.dim_size(d) != 1 && array.stride(d) != array.stride(d + 1) * array.dim_size(d + 1)) {
+					return 0;
+				}
+			}
+
+			return array.stride(3);
+		}
+
+		/* Lays out the receptive fields of image `n` of `input` as the columns of `cols`, a contiguous (C R S) x (P Q)
+			matrix: cols((c R + r) S + s, p Q + q) = input(n, c, p stride_h + r dilation_h - padding_h, ...), or zero in the
+			padding. Rows are split across threads. */
+		template<class InputArray, typename T>
+		void im2col(InputArray const& input, std::size_t n, std::size_t r_size, std::size_t s_size, conv2d_options const& options, T* cols)
+		{
+			std::size_t const channels = input.dim_size(1);
+			std::size_t const h_size = input.dim_size(2);
+			std::size_t const w_size = input.dim_size(3);
+			std::size_t const p_size = output_size(h_size, r_size, options.stride_h, options.padding_h, options.dilation_h);
+			std::size_t const q_size = output_size(w_size, s_size, options.stride_w, options.padding_w, options.dilation_w);
+			std::size_t const rows = channels * r_size * s_size;
+			std::size_t const length = p_size * q_size;
+			std::size_t const w_stride = input.stride(3);
+			std::size_t const rows_per_chunk = std::max<std::size_t>(tc::parallel::chunk_size / std::max<std::size_t>(length, 1), 1);
+
+			tc::parallel::for_each_chunk(rows, [&](std::size_t begin, std::size_t end) {
+				for (std::size_t row = begin; row < end; ++row) {
+					std::size_t const c = row / (r_size * s_size);
+					std::size_t const r = row / s_size % r_size;
+					std::size_t const s = row % s_size;
+					auto const [p_first, p_last] = valid_range(p_size, h_size, options.stride_h, r * options.dilation_h, options.padding_h);
+					auto const [q_first, q_last] = valid_range(q_size, w_size, options.stride_w, s * options.dilation_w, options.padding_w);
+					T* const dst = cols + row * length;
+
+					std::fill_n(dst, p_first * q_size, T{});
+
+					for (std::size_t p = p_first; p < p_last; ++p) {
+						std::size_t const h = p * options.stride_h + r * options.dilation_h - options.padding_h;
+						auto const src = input.data() + n * input.stride(0) + c * input.stride(1) + h * input.stride(2)
+							+ (q_first * options.stride_w + s * options.dilation_w - options.padding_w) * w_stride;
+						T* const line = dst + p * q_size;
+						std::size_t const step = options.stride_w * w_stride;
+
+						std::fill_n(line, q_first, T{});
+
+						if (step == 1) {
+							for (std::size_t q = q_first; q < q_last; ++q) {
+								line[q] = src[q - q_first];
+							}
+						}
+						else {
+							for (std::size_t q = q_first; q < q_last; ++q) {
+								line[q] = src[(q - q_first) * step];
+							}
+						}
+
+						std::fill_n(line + q_last, q_size - q_last, T{});
+					}
+
+					std::fill_n(dst + p_last * q_size, (p_size - p_last) * q_size, T{});
+				}
+			}, rows_per_chunk);
+		}
+
+		/* Adds the columns of `cols`, laid out as by im2col, back into image `n` of `result`:
+			result(n, c, h, w) += cols(row, column) for every row and column that im2col would have read (n, c, h, w) into.
+			Channels are split across threads, so no two threads write the same element. */
+		template<typename T, class OutputArray>
+		void col2im(T const* cols, std::size_t n, std::size_t r_size, std::size_t s_size, conv2d_options const& options, OutputArray& result)
+		{
+			std::size_t const channels = result.dim_size(1);
+			std::size_t const h_size = result.dim_size(2);
+			std::size_t const w_size = result.dim_size(3);
+			std::size_t const p_size = output_size(h_size, r_size, options.stride_h, options.padding_h, options.dilation_h);
+			std::size_t const q_size = output_size(w_size, s_size, options.stride_w, options.padding_w, options.dilation_w);
+			std::size_t const length = p_size * q_size;
+			std::size_t const w_stride = result.stride(3);
+			std::size_t const channels_per_chunk = std::max<std::size_t>(tc::parallel::chunk_size / std::max<std::size_t>(r_size * s_size * length, 1), 1);
+
+			tc::parallel::for_each_chunk(channels, [&](std::size_t begin, std::size_t end) {
+				for (std::size_t c = begin; c < end; ++c) {
+					for (std::size_t r = 0; r < r_size; ++r) {
+						for (std::size_t s = 0; s < s_size; ++s) {
+							auto const [p_first, p_last] = valid_range(p_size, h_size, options.stride_h, r * options.dilation_h, options.padding_h);
+							auto const [q_first, q_last] = valid_range(q_size, w_size, options.stride_w, s * options.dilation_w, options.padding_w);
+							T const* const src = cols + ((c * r_size + r) * s_size + s) * length;
+							std::size_t const step = options.stride_w * w_stride;
+
+							for (std::size_t p = p_first; p < p_last; ++p) {
+								std::size_t const h = p * options.stride_h + r * options.dilation_h - options.padding_h;
+								auto const dst = result.data() + n * result.stride(0) + c * result.stride(1) + h * result.stride(2)
+									+ (q_first * options.stride_w + s * options.dilation_w - options.padding_w) * w_stride;
+								T const* const line = src + p * q_size;
+
+								for (std::size_t q = q_first; q < q_last; ++q) {
+									dst[(q - q_first) * step] += line[q];
+								}
+							}
+						}
+					}
+				}
+			}, channels_per_chunk);
+		}
+
+		/* Convolution as matrix multiplication: for each image, the receptive fields are laid out by im2col and the output
+			image (K x P Q) is the product of the weights (K x C R S) and the columns (C R S x P Q), by tc::gemm::parallel_gemm.
+			Suits many channels, where the product is large enough to run near peak. The columns take C R S P Q elements of
+			the calling thread's tc::workspace arena. */
+		template<class InputArray, class WeightArray, class OutputArray>
+		void conv2d_im2col(InputArray const& input, WeightArray const& weights, OutputArray& result, conv2d_options const& options = {})
+		{
+			using T = typename OutputArray::value_type;
+
+			std::size_t const batch = input.dim_size(0);
+			std::size_t const k_size = weights.dim_size(0);
+			std::size_t const depth = weights.dim_size(1) * weights.dim_size(2) * weights.dim_size(3);
+			std::size_t const length = result.dim_size(2) * result.dim_size(3);
+
+			if (result.size() == 0) {
+				return;
+			}
+
+			tc::workspace::scope scratch;
+			T* const cols = scratch.allocate<T>(depth * length);
+
+			// Weights as a K x (C R S) matrix, copied if its columns cannot be walked with one stride.
+			T const* a = weights.data();
+			std::size_t rsa = weights.stride(0);
+			std::size_t csa = merged_stride(weights, 1);
+
+			if (csa == 0) {
+				T* const packed = scratch.allocate<T>(k_size * depth);
+				tc::array_view::array_view4d<T> packed_view{packed, weights.dim_sizes()};
+
+				tc::array_ops::a_map(packed_view, [](T x){ return x; }, weights);
+				a = packed;
+				rsa = depth;
+				csa = 1;
+			}
+
+			// Output images as K x (P Q) matrices, computed in scratch if their columns cannot be walked with one stride.
+			std::size_t const csc = merged_stride(result, 2);
+			T* const staging = csc == 0 ? scratch.allocate<T>(k_size * length) : nullptr;
+
+			for (std::size_t n = 0; n < batch; ++n) {
+				im2col(input, n, weights.dim_size(2), weights.dim_size(3), options, cols);
+
+				if (staging == nullptr) {
+					tc::gemm::parallel_gemm<T>(k_size, length, depth,
+						a, static_cast<std::ptrdiff_t>(rsa), static_cast<std::ptrdiff_t>(csa),
+						cols, static_cast<std::ptrdiff_t>(length), 1,
+						result.data() + n * result.stride(0), static_cast<std::ptrdiff_t>(result.stride(1)), static_cast<std::ptrdiff_t>(csc));
+				}
+				else {
+					tc::gemm::parallel_gemm<T>(k_size, length, depth,
+						a, static_cast<std::ptrdiff_t>(rsa), static_cast<std::ptrdiff_t>(csa),
+						cols, static_cast<std::ptrdiff_t>(length), 1,
+						staging, static_cast<std::ptrdiff_t>(length), 1);
+
+					auto image = result[n];
+					tc::array_view::array_view3d<T> const staged{staging, image.dim_sizes()};
+
+					tc::array_ops::a_map(image, [](T x){ return x; }, staged);
+				}
+			}
+		}
+
+		/* Direct convolution, register blocked over output channels and output columns.
+			Each task computes one output row of `block` output channels. With GCC and Clang, and stride_w 1 over contiguous
+			input rows, the input rows under the kernel are staged zero padded in the thread's tc::workspace arena,
+			then the row is computed in tiles of two SIMD vectors (tc::gemm::simd_width) of columns by `block` channels, held
+			in registers over the whole sum so that each input vector is loaded once for all of the block's channels.
+			Other strides are computed one column at a time. The weights are first packed by block of channels, tap by tap.
+			Suits small kernels over few channels, where im2col would spend longer laying out the columns than multiplying. */
+		template<class InputArray, class WeightArray, class OutputArray>
+		void conv2d_direct(InputArray const& input, WeightArray const& weights, OutputArray& result, conv2d_options const& options = {})
+		{
+			using T = typename OutputArray::value_type;
+
+			// Output channels computed together.
+			constexpr std::size_t block = 4;
+
+			// Output columns computed together, two SIMD vectors.
+			constexpr std::size_t tile = 2 * tc::gemm::simd_width<T>;
+
+			std::size_t const batch = input.dim_size(0);
+			std::size_t const channels = input.dim_size(1);
+			std::size_t const h_size = input.dim_size(2);
+			std::size_t const w_size = input.dim_size(3);
+			std::size_t const k_size = weights.dim_size(0);
+			std::size_t const r_size = weights.dim_size(2);
+			std::size_t const s_size = weights.dim_size(3);
+			std::size_t const p_size = result.dim_size(2);
+			std::size_t const q_size = result.dim_size(3);
+			std::size_t const k_blocks = (k_size + block - 1) / block;
+			std::size_t const taps = channels * r_size * s_size;
+			std::size_t const work = std::max<std::size_t>(block * taps * q_size, 1);
+
+			bool const unit = options.stride_w == 1 && input.stride(3) == 1;
+
+			// Length of a zero padded input row, whole tiles of output columns plus the kernel's reach.
+			std::size_t const row_length = std::max((q_size + tile - 1) / tile * tile + (s_size - 1) * options.dilation_w, options.padding_w + w_size);
+
+			// Gets the pointer to input element (n, c, h, w), h and w being positions in the unpadded input.
+			auto const at = [&](std::size_t n, std::size_t c, std::size_t h, std::size_t w) {
+				return input.data() + n * input.stride(0) + c * input.stride(1) + h * input.stride(2) + w * input.stride(3);
+			};
+
+			// Checks whether kernel row r of output row p falls in the input, and gets its input row.
+			auto const input_row = [&](std::size_t p, std::size_t r, std::size_t& h) {
+				std::size_t const position = p * options.stride_h + r * options.dilation_h;
+
+				h = position - options.padding_h;
+				return position >= options.padding_h && h < h_size;
+			};
+
+			// Weights by block of output channels, then tap, `block` per tap, zero for channels past the end.
+			tc::workspace::scope shared;
+			T* const packed_weights = shared.allocate<T>(k_blocks * taps * block);
+
+			for (std::size_t k = 0; k < k_blocks * block; ++k) {
+				T* dst = packed_weights + k / block * taps * block + k % block;
+
+				for (std::size_t c = 0; c < channels; ++c) {
+					for (std::size_t r = 0; r < r_size; ++r) {
+						for (std::size_t s = 0; s < s_size; ++s, dst += block) {
+							*dst = k < k_size ? weights(k, c, r, s) : T{};
+						}
+					}
+				}
+			}
+
+			tc::parallel::for_each_chunk(batch * k_blocks * p_size, [&](std::size_t begin, std::size_t end) {
+				tc::workspace::scope scratch;
+				T* const rows = unit ? scratch.allocate<T>(channels * r_size * row_length) : nullptr;
+
+				for (std::size_t task = begin; task < end; ++task) {
+					std::size_t const p = task % p_size;
+					std::size_t const k_block = task / p_size % k_blocks;
+					std::size_t const n = task / p_size / k_blocks;
+					std::size_t const k0 = k_block * block;
+					std::size_t const kb_size = std::min(block, k_size - k0);
+					T const* const packed = packed_weights + k_block * taps * block;
+
+					// Gets the pointer to output element (k0 + kb, p, q).
+					auto const out = [&](std::size_t kb, std::size_t q) {
+						return result.data() + n * result.stride(0) + (k0 + kb) * result.stride(1) + p * result.stride(2) + q * result.stride(3);
+					};
+
+					bool vectorised = false;
+
+					#if defined(__GNUC__)
+						constexpr std::size_t w = tc::gemm::simd_width<T>;
+						constexpr std::size_t nv = tile / w;
+						typedef T vector __attribute__((vector_size(w * sizeof(T))));
+
+						if (unit) {
+							vectorised = true;
+
+							// Stage the input rows under the kernel, zero padded so that every tile reads in bounds.
+							for (std::size_t c = 0; c < channels; ++c) {
+								for (std::size_t r = 0; r < r_size; ++r) {
+									std::size_t h;
+
+									if (!input_row(p, r, h)) {
+										continue;
+									}
+
+									T* const line = rows + (c * r_size + r) * row_length;
+									T const* const src = at(n, c, h, 0);
+
+									std::fill_n(line, options.padding_w, T{});
+									std::copy_n(src, w_size, line + options.padding_w);
+									std::fill_n(line + options.padding_w + w_size, row_length - options.padding_w - w_size, T{});
+								}
+							}
+
+							for (std::size_t q0 = 0; q0 < q_size; q0 += tile) {
+								vector acc[block][nv] = {};
+
+								for (std::size_t c = 0; c < channels; ++c) {
+									for (std::size_t r = 0; r < r_size; ++r) {
+										std::size_t h;
+
+										if (!input_row(p, r, h)) {
+											continue;
+										}
+
+										T const* const line = rows + (c * r_size + r) * row_length + q0;
+										T const* const weight = packed + (c * r_size + r) * s_size * block;
+
+										for (std::size_t s = 0; s < s_size; ++s) {
+											vector x[nv];
+
+											#pragma GCC unroll 8
+											for (std::size_t j = 0; j < nv; ++j) {
+												std::memcpy(&x[j], line + s * options.dilation_w + j * w, sizeof(vector));
+											}
+
+											#pragma GCC unroll 8
+											for (std::size_t kb = 0; kb < block; ++kb) {
+												T const weight_kb = weight[s * block + kb];
+
+												#pragma GCC unroll 8
+												for (std::size_t j = 0; j < nv; ++j) {
+													acc[kb][j] += weight_kb * x[j];
+												}
+											}
+										}
+									}
+								}
+
+								std::size_t const columns = std::min(tile, q_size - q0);
+
+								for (std::size_t kb = 0; kb < kb_size; ++kb) {
+									T values[tile];
+
+									std::memcpy(values, acc[kb], sizeof(values));
+
+									for (std::size_t e = 0; e < columns; ++e) {
+										*out(kb, q0 + e) = values[e];
+									}
+								}
+							}
+						}
+					#endif
+
+					// Other strides, or without vector extensions, one column at a time.
+					for (std::size_t q = 0; q < q_size && !vectorised; ++q) {
+						std::array<T, block> acc{};
+
+						for (std::size_t c = 0; c < channels; ++c) {
+							for (std::size_t r = 0; r < r_size; ++r) {
+								std::size_t h;
+
+								if (!input_row(p, r, h)) {
+									continue;
+								}
+
+								T const* const weight = packed + (c * r_size + r) * s_size * block;
+
+								for (std::size_t s = 0; s < s_size; ++s) {
+									std::size_t const position = q * options.stride_w + s * options.dilation_w;
+
+									if (position < options.padding_w || position - options.padding_w >= w_size) {
+										continue;
+									}
+
+									T const x = *at(n, c, h, position - options.padding_w);
+
+									for (std::size_t kb = 0; kb < block; ++kb) {
+										acc[kb] += weight[s * block + kb] * x;
+									}
+								}
+							}
+						}
+
+						for (std::size_t kb = 0; kb < kb_size; ++kb) {
+							*out(kb, q) = acc[kb];
+						}
+					}
+				}
+			}, std::max<std::size_t>(tc::parallel::chunk_size / work, 1));
+		}
+
+		/* 2-D convolution forward pass, result = input * weights (see above).
+			3 x 3 kernels with stride_w 1 over at most direct_channel_limit input channels use conv2d_direct, other shapes
+			conv2d_im2col.
+			Dimensions are checked for debug builds. */
+		template<class InputArray, class WeightArray, class OutputArray>
+		void conv2d(InputArray const& input, WeightArray const& weights, OutputArray& result, conv2d_options const& options = {})
+		{
+			static_assert(std::is_same_v<std::remove_cv_t<typename InputArray::value_type>, typename OutputArray::value_type>
+				&& std::is_same_v<std::remove_cv_t<typename WeightArray::value_type>, typename OutputArray::value_type>, "tensors share a value type");
+
+			#ifdef _DEBUG
+				assert(options.stride_h > 0 && options.stride_w > 0 && options.dilation_h > 0 && options.dilation_w > 0);
+				assert(weights.dim_size(1) == input.dim_size(1));
+				assert(result.dim_size(0) == input.dim_size(0));
+				assert(result.dim_size(1) == weights.dim_size(0));
+				assert(result.dim_size(2) == output_size(input.dim_size(2), weights.dim_size(2), options.stride_h, options.padding_h, options.dilation_h));
+				assert(result.dim_size(3) == output_size(input.dim_size(3), weights.dim_size(3), options.stride_w, options.padding_w, options.dilation_w));
+			#endif
+
+			if (weights.dim_size(2) == 3 && weights.dim_size(3) == 3 && options.stride_w == 1 && input.dim_size(1) <= direct_channel_limit) {
+				conv2d_direct(input, weights, result, options);
+			}
+			else {
+				conv2d_im2col(input, weights, result, options);
+			}
+		}
+
+		/* 2-D convolution backward pass to the input, result = gradient of the loss with respect to the input, given
+			`output_gradient`, its gradient with respect to the output (N x K x P x Q).
+			For each image the column gradient weights^T output_gradient (C R S x P Q) is computed by parallel_gemm and added
+			back into the image by col2im. */
+		template<class GradientArray, class WeightArray, class OutputArray>
+		void conv2d_backward_data(GradientArray const& output_gradient, WeightArray const& weights, OutputArray& result, conv2d_options const& options = {})
+		{
+			using T = typename OutputArray::value_type;
+
+			static_assert(std::is_same_v<std::remove_cv_t<typename GradientArray::value_type>, T>
+				&& std::is_same_v<std::remove_cv_t<typename WeightArray::value_type>, T>, "tensors share a value type");
+
+			#ifdef _DEBUG
+				assert(weights.dim_size(1) == result.dim_size(1));
+				assert(output_gradient.dim_size(0) == result.dim_size(0));
+				assert(output_gradient.dim_size(1) == weights.dim_size(0));
+				assert(output_gradient.dim_size(2) == output_size(result.dim_size(2), weights.dim_size(2), options.stride_h, options.padding_h, options.dilation_h));
+				assert(output_gradient.dim_size(3) == output_size(result.dim_size(3), weights.dim_size(3), options.stride_w, options.padding_w, options.dilation_w));
+			#endif
+
+			tc::array_ops::a_map(result, []{ return T{}; });
+
+			std::size_t const batch = result.dim_size(0);
+			std::size_t const k_size = weights.dim_size(0);
+			std::size_t const depth = weights.dim_size(1) * weights.dim_size(2) * weights.dim_size(3);
+			std::size_t const length = output_gradient.dim_size(2) * output_gradient.dim_size(3);
+
+			if (result.size() == 0 || length == 0) {
+				return;
+			}
+
+			tc::workspace::scope scratch;
+			T* const cols = scratch.allocate<T>(depth * length);
+
+			T const* a = weights.data();
+			std::size_t rsa = weights.stride(0);
+			std::size_t csa = merged_stride(weights, 1);
+
+			if (csa == 0) {
+				T* const packed = scratch.allocate<T>(k_size * depth);
+				tc::array_view::array_view4d<T> packed_view{packed, weights.dim_sizes()};
+
+				tc::array_ops::a_map(packed_view, [](T x){ return x; }, weights);
+				a = packed;
+				rsa = depth;
+				csa = 1;
+			}
+
+			// Gradient images as K x (P Q) matrices, copied if their columns cannot be walked with one stride.
+			std::size_t csb = merged_stride(output_gradient, 2);
+			T* const staging = csb == 0 ? scratch.allocate<T>(k_size * length) : nullptr;
+
+			for (std::size_t n = 0; n < batch; ++n) {
+				T const* b = output_gradient.data() + n * output_gradient.stride(0);
+				std::size_t rsb = output_gradient.stride(1);
+
+				if (staging != nullptr) {
+					tc::array_view::array_view3d<T> staged{staging, k_size, output_gradient.dim_size(2), output_gradient.dim_size(3)};
+
+					tc::array_ops::a_map(staged, [](T x){ return x; }, output_gradient[n]);
+					b = staging;
+					rsb = length;
+					csb = 1;
+				}
+
+				// weights^T, (C R S) x K.
+				tc::gemm::parallel_gemm<T>(depth, length, k_size,
+					a, static_cast<std::ptrdiff_t>(csa), static_cast<std::ptrdiff_t>(rsa),
+					b, static_cast<std::ptrdiff_t>(rsb), static_cast<std::ptrdiff_t>(csb),
+					cols, static_cast<std::ptrdiff_t>(length), 1);
+
+				col2im(cols, n, weights.dim_size(2), weights.dim_size(3), options, result);
+			}
+		}
+
+		/* 2-D convolution backward pass to the weights, result = gradient of the loss with respect to the weights, given
+			the forward pass's `input` and `output_gradient`, the gradient with respect to the output (N x K x P x Q).
+			The sum over images of output_gradient (K x P Q) times the transposed columns of im2col (P Q x C R S), each
+			product accumulated into the result by parallel_gemm. */
+		template<class InputArray, class GradientArray, class OutputArray>
+		void conv2d_backward_weights(InputArray const& input, GradientArray const& output_gradient, OutputArray& result, conv2d_options const& options = {})
+		{
+			using T = typename OutputArray::value_type;
+
+			static_assert(std::is_same_v<std::remove_cv_t<typename InputArray::value_type>, T>
+				&& std::is_same_v<std::remove_cv_t<typename GradientArray::value_type>, T>, "tensors share a value type");
+
+			#ifdef _DEBUG
+				assert(result.dim_size(1) == input.dim_size(1));
+				assert(output_gradient.dim_size(0) == input.dim_size(0));
+				assert(output_gradient.dim_size(1) == result.dim_size(0));
+				assert(output_gradient.dim_size(2) == output_size(input.dim_size(2), result.dim_size(2), options.stride_h, options.padding_h, options.dilation_h));
+				assert(output_gradient.dim_size(3) == output_size(input.dim_size(3), result.dim_size(3), options.stride_w, options.padding_w, options.dilation_w));
+			#endif
+
+			std::size_t const batch = input.dim_size(0);
+			std::size_t const k_size = result.dim_size(0);
+			std::size_t const depth = result.dim_size(1) * result.dim_size(2) * result.dim_size(3);
+			std::size_t const length = output_gradient.dim_size(2) * output_gradient.dim_size(3);
+
+			if (result.size() == 0) {
+				return;
+			}
+
+			tc::array_ops::a_map(result, []{ return T{}; });
+
+			if (length == 0) {
+				return;
+			}
+
+			tc::workspace::scope scratch;
+			T* const cols = scratch.allocate<T>(depth * length);
+
+			// Weight gradient as a K x (C R S) matrix, accumulated in scratch if its columns cannot be walked with one stride.
+			std::size_t const csc = merged_stride(result, 1);
+			T* const c = csc == 0 ? scratch.allocate<T>(k_size * depth) : result.data();
+			std::size_t const rsc = csc == 0 ? depth : result.stride(0);
+
+			if (csc == 0) {
+				std::fill_n(c, k_size * depth, T{});
+			}
+
+			std::size_t csa = merged_stride(output_gradient, 2);
+			T* const staging = csa == 0 ? scratch.allocate<T>(k_size * length) : nullptr;
+
+			for (std::size_t n = 0; n < batch; ++n) {
+				T const* a = output_gradient.data() + n * output_gradient.stride(0);
+				std::size_t rsa = output_gradient.stride(1);
+
+				if (staging != nullptr) {
+					tc::array_view::array_view3d<T> staged{staging, k_size, output_gradient.dim_size(2), output_gradient.dim_size(3)};
+
+					tc::array_ops::a_map(staged, [](T x){ return x; }, output_gradient[n]);
+					a = staging;
+					rsa = length;
+					csa = 1;
+				}
+
+				im2col(input, n, result.dim_size(2), result.dim_size(3), options, cols);
+
+				// cols^T, (P Q) x (C R S).
+				tc::gemm::parallel_gemm<T>(k_size, depth, length, T{1},
+					a, static_cast<std::ptrdiff_t>(rsa), static_cast<std::ptrdiff_t>(csa),
+					cols, 1, static_cast<std::ptrdiff_t>(length),
+					T{1}, c, static_cast<std::ptrdiff_t>(rsc), static_cast<std::ptrdiff_t>(csc == 0 ? 1 : csc));
+			}
+
+			if (csc == 0) {
+				tc::array_view::array_view4d<T> const accumulated{c, result.dim_sizes()};
+
+				tc::array_ops::a_map(result, [](T x){ return x; }, accumulated);
+			}
+		}
+
+	}
+}
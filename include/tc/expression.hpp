@@ -0,0 +1,299 @@
+#pragma once
+
+#ifdef _DEBUG
+	#include <cassert>			// assert
+#endif
+#include <cstddef>				// std::size_t
+#include <functional>			// std::divides, std::minus, std::multiplies, std::negate, std::plus
+#include <tuple>				// std::tuple, std::get
+#include <type_traits>			// std::decay_t, std::enable_if_t, std::false_type, std::is_arithmetic_v, std::true_type
+#include <utility>				// std::index_sequence, std::index_sequence_for
+#include "matrix.hpp"			// tc::matrix::matrix
+#include "matrix_view.hpp"		// tc::matrix_view::matrix_view
+#include "vector.hpp"			// tc::vector::vector
+#include "vector_view.hpp"		// tc::vector_view::vector_view
+
+
+namespace tc {
+	namespace expression {
+
+		/* Lazily evaluated elementwise expression.
+			Element (indices...) is `operation` applied to element (indices...) of each operand, scalar operands taking the
+			same value at every index. Nothing is computed until an element is requested, so a whole tree of nodes is
+			evaluated in one pass, without temporaries, by m_eval or v_eval.
+			Operands are held by value, views and nodes are cheap to copy. Owning matrices and vectors are held as views
+			(see held_operand), so they must outlive the expression. */
+		template<class Operation, class... Operands>
+		class node {
+		public:
+
+			/* Special members */
+
+			// Constructor from operation and operands.
+			node(Operation operation, Operands const&... operands) :
+				_operation{operation},
+				_operands{operands...}
+			{
+				#ifdef _DEBUG
+					assert((has_size(operands, shape().size()) && ...));
+				#endif
+			}
+
+
+			/* Operators */
+
+			/* Function call - element access.
+				Takes one index for vector expressions, a row and a column for matrix expressions. */
+			template<typename... Indices>
+			auto operator()(Indices... indices) const
+			{
+				return evaluate(std::index_sequence_for<Operands...>{}, indices...);
+			}
+
+
+			/* General member functions */
+
+			// Gets the number of columns of a matrix expression.
+			std::size_t columns() const
+			{
+				return shape().columns();
+			}
+
+			// Gets the number of rows of a matrix expression.
+			std::size_t rows() const
+			{
+				return shape().rows();
+			}
+
+			// Gets the number of elements.
+			std::size_t size() const
+			{
+				return shape().size();
+			}
+
+
+		private:
+
+			/* Member constants */
+
+			// Whether an operand type is a scalar, taking the same value at every index.
+			template<class Operand>
+			static constexpr bool is_scalar = std::is_arithmetic_v<Operand>;
+
+			// Position of the first non-scalar operand, which gives the expression its shape.
+			static constexpr std::size_t shape_index = []() {
+				constexpr bool scalars[] = {is_scalar<Operands>...};
+				std::size_t i = 0;
+
+				while (scalars[i]) {
+					++i;
+				}
+				return i;
+			}();
+
+
+			/* Member functions */
+
+			// Gets the operand giving the expression its shape.
+			auto const& shape() const
+			{
+				return std::get<shape_index>(_operands);
+			}
+
+			// Checks whether an operand has `size` elements, scalars fit any size.
+			template<class Operand>
+			static bool has_size(Operand const& operand, std::size_t size)
+			{
+				if constexpr (is_scalar<Operand>) {
+					return true;
+				}
+				else {
+					return operand.size() == size;
+				}
+			}
+
+			// Gets element (indices...) of an operand.
+			template<class Operand, typename... Indices>
+			static auto element(Operand const& operand, Indices... indices)
+			{
+				if constexpr (is_scalar<Operand>) {
+					return operand;
+				}
+				else {
+					return operand(indices...);
+				}
+			}
+
+			// Applies the operation to element (indices...) of every operand.
+			template<std::size_t... I, typename... Indices>
+			auto evaluate(std::index_sequence<I...>, Indices... indices) const
+			{
+				return _operation(element(std::get<I>(_operands), indices...)...);
+			}
+
+
+			/* Member variables */
+
+			// Operation applied to the operands' elements.
+			Operation _operation;
+
+			// Operands of the operation.
+			std::tuple<Operands...> _operands;
+		};
+
+
+		/* Operand traits */
+
+		/* std::true_type if T may be an operand of an expression (a matrix, vector, matrix_view, vector_view or node),
+			otherwise std::false_type. */
+		template<class T>
+		struct is_operand : std::false_type {};
+
+		// Specialisation for matrix_view.
+		template<typename T, typename Layout>
+		struct is_operand<tc::matrix_view::matrix_view<T, Layout>> : std::true_type {};
+
+		// Specialisation for vector_view.
+		template<typename T>
+		struct is_operand<tc::vector_view::vector_view<T>> : std::true_type {};
+
+		// Specialisation for node.
+		template<class Operation, class... Operands>
+		struct is_operand<node<Operation, Operands...>> : std::true_type {};
+
+		// Specialisation for matrix.
+		template<typename T, typename Layout, bool Padded>
+		struct is_operand<tc::matrix::matrix<T, Layout, Padded>> : std::true_type {};
+
+		// Specialisation for vector.
+		template<typename T>
+		struct is_operand<tc::vector::vector<T>> : std::true_type {};
+
+		// true if T may be an operand of an expression, otherwise false.
+		template<class T>
+		constexpr inline bool is_operand_v = is_operand<std::decay_t<T>>::value;
+
+		// true if T1 and T2 may be operands of a binary expression, ie both operands or scalars and at least one an operand.
+		template<class T1, class T2>
+		constexpr inline bool is_binary_v = (is_operand_v<T1> || std::is_arithmetic_v<T1>) && (is_operand_v<T2> || std::is_arithmetic_v<T2>)
+			&& (is_operand_v<T1> || is_operand_v<T2>);
+
+		// true if one of T1 and T2 is an operand and the other a scalar, otherwise false.
+		template<class T1, class T2>
+		constexpr inline bool is_scaling_v = (is_operand_v<T1> && std::is_arithmetic_v<T2>) || (std::is_arithmetic_v<T1> && is_operand_v<T2>);
+
+
+		/* Provides member type alias `type`, the type an operand of type T is held as in a node.
+			Views, nodes and scalars are held as themselves. */
+		template<class T>
+		struct held_operand {
+			using type = T;
+		};
+
+		/* Provides member type alias `type`, the type an operand of type T is held as in a node.
+			Specialisation for matrix, which is move-only, held as a read-only view of its elements. */
+		template<typename T, typename Layout, bool Padded>
+		struct held_operand<tc::matrix::matrix<T, Layout, Padded>> {
+			using type = typename tc::matrix::matrix<T, Layout, Padded>::const_view_type;
+		};
+
+		/* Provides member type alias `type`, the type an operand of type T is held as in a node.
+			Specialisation for vector, which is move-only, held as a read-only view of its elements. */
+		template<typename T>
+		struct held_operand<tc::vector::vector<T>> {
+			using type = typename tc::vector::vector<T>::const_view_type;
+		};
+
+		// Type an operand of type T is held as in a node.
+		template<class T>
+		using held_operand_t = typename held_operand<T>::type;
+
+
+		/* Expression builders */
+
+		// Elementwise application of a function to the elements of one or more operands.
+		template<typename Function, class... Operands, typename = std::enable_if_t<(is_operand_v<Operands> && ...)>>
+		node<Function, held_operand_t<Operands>...> map(Function function, Operands const&... operands)
+		{
+			return {function, operands...};
+		}
+
+		// Elementwise (Hadamard) product.
+		template<class Operand1, class Operand2, typename = std::enable_if_t<is_operand_v<Operand1> && is_operand_v<Operand2>>>
+		node<std::multiplies<>, held_operand_t<Operand1>, held_operand_t<Operand2>> hprod(Operand1 const& lhs, Operand2 const& rhs)
+		{
+			return {{}, lhs, rhs};
+		}
+
+		// Elementwise addition, a scalar operand is added to every element.
+		template<class Operand1, class Operand2, typename = std::enable_if_t<is_binary_v<Operand1, Operand2>>>
+		node<std::plus<>, held_operand_t<Operand1>, held_operand_t<Operand2>> operator+(Operand1 const& lhs, Operand2 const& rhs)
+		{
+			return {{}, lhs, rhs};
+		}
+
+		// Elementwise subtraction, a scalar operand is subtracted from (or has subtracted from it) every element.
+		template<class Operand1, class Operand2, typename = std::enable_if_t<is_binary_v<Operand1, Operand2>>>
+		node<std::minus<>, held_operand_t<Operand1>, held_operand_t<Operand2>> operator-(Operand1 const& lhs, Operand2 const& rhs)
+		{
+			return {{}, lhs, rhs};
+		}
+
+		/* Scalar multiplication.
+			One operand must be a scalar, hprod is the elementwise product of two operands. */
+		template<class Operand1, class Operand2, typename = std::enable_if_t<is_scaling_v<Operand1, Operand2>>>
+		node<std::multiplies<>, held_operand_t<Operand1>, held_operand_t<Operand2>> operator*(Operand1 const& lhs, Operand2 const& rhs)
+		{
+			return {{}, lhs, rhs};
+		}
+
+		// Elementwise division, a scalar operand divides (or is divided by) every element.
+		template<class Operand1, class Operand2, typename = std::enable_if_t<is_binary_v<Operand1, Operand2>>>
+		node<std::divides<>, held_operand_t<Operand1>, held_operand_t<Operand2>> operator/(Operand1 const& lhs, Operand2 const& rhs)
+		{
+			return {{}, lhs, rhs};
+		}
+
+		// Elementwise negation.
+		template<class Operand, typename = std::enable_if_t<is_operand_v<Operand>>>
+		node<std::negate<>, held_operand_t<Operand>> operator-(Operand const& operand)
+		{
+			return {{}, operand};
+		}
+
+	}
+
+	// Makes the expression operators visible to argument-dependent lookup on matrices, vectors and views.
+
+	namespace matrix {
+		using tc::expression::hprod;
+		using tc::expression::operator+;
+		using tc::expression::operator-;
+		using tc::expression::operator*;
+		using tc::expression::operator/;
+	}
+
+	namespace matrix_view {
+		using tc::expression::hprod;
+		using tc::expression::operator+;
+		using tc::expression::operator-;
+		using tc::expression::operator*;
+		using tc::expression::operator/;
+	}
+
+	namespace vector {
+		using tc::expression::hprod;
+		using tc::expression::operator+;
+		using tc::expression::operator-;
+		using tc::expression::operator*;
+		using tc::expression::operator/;
+	}
+
+	namespace vector_view {
+		using tc::expression::hprod;
+		using tc::expression::operator+;
+		using tc::expression::operator-;
+		using tc::expression::operator*;
+		using tc::expression::operator/;
+	}
+}
@@ -0,0 +1,437 @@
+#pragma once
+
+#include <algorithm>		// std::min
+#include <cstddef>			// std::size_t, std::ptrdiff_t
+#include <cstring>			// std::memcpy
+#include "parallel.hpp"		// tc::parallel::for_each_task, tc::parallel::thread_count
+#include "workspace.hpp"		// tc::workspace::scope
+
+
+namespace tc {
+	namespace gemm {
+
+		/* Number of elements of T in one SIMD register of the target.
+			Only used to size the register tile, the kernels themselves are plain C++ written to auto-vectorise.
+			Capped at 256 bit, compilers vectorise the register tile poorly at 512 bit. */
+		template<typename T>
+		constexpr inline std::size_t simd_width =
+		#if defined(__AVX__)
+			32 / sizeof(T);
+		#else
+			16 / sizeof(T);
+		#endif
+
+		/* Register and cache blocking parameters of the packed GEMM kernel.
+			The register tile is mr x nr, an mr x kc micro-panel of A and a kc x nr micro-panel of B share L1,
+			an mc x kc block of A stays in L2 and a kc x nc panel of B stays in L3. */
+		template<typename T>
+		struct blocking {
+			// Assumed data cache sizes, in bytes.
+			static constexpr std::size_t l1_bytes = 32 * 1024;
+			static constexpr std::size_t l2_bytes = 256 * 1024;
+			static constexpr std::size_t l3_bytes = 8 * 1024 * 1024;
+
+			// Register tile rows.
+			static constexpr std::size_t mr = 6;
+
+			// Register tile columns, two SIMD registers wide.
+			static constexpr std::size_t nr = 2 * simd_width<T>;
+
+			// Depth of the packed panels, a B micro-panel takes half of L1.
+			static constexpr std::size_t kc = (l1_bytes / 2) / (nr * sizeof(T));
+
+			// Rows of the packed A block, takes half of L2.
+			static constexpr std::size_t mc = ((l2_bytes / 2) / (kc * sizeof(T))) / mr * mr;
+
+			// Columns of the packed B panel, takes half of L3.
+			static constexpr std::size_t nc = ((l3_bytes / 2) / (kc * sizeof(T))) / nr * nr;
+		};
+
+		/* Packs an mc x kc block of A into row panels of height mr.
+			Each panel is stored column by column (mr contiguous elements per k), short panels are zero padded. */
+		template<typename T, std::size_t MR>
+		void pack_a(std::size_t mc, std::size_t kc, T const* a, std::ptrdiff_t rsa, std::ptrdiff_t csa, T* packed)
+		{
+			for (std::size_t i = 0; i < mc; i += MR) {
+				std::size_t const rows = std::min(MR, mc - i);
+				T const* panel = a + static_cast<std::ptrdiff_t>(i) * rsa;
+
+				for (std::size_t p = 0; p < kc; ++p) {
+					T const* col = panel + static_cast<std::ptrdiff_t>(p) * csa;
+					std::size_t r = 0;
+
+					for (; r < rows; ++r) {
+						packed[r] = col[static_cast<std::ptrdiff_t>(r) * rsa];
+					}
+					for (; r < MR; ++r) {
+						packed[r] = T{};
+					}
+
+					packed += MR;
+				}
+			}
+		}
+
+		/* Packs a kc x nc panel of B into column panels of width nr.
+			Each panel is stored row by row (nr contiguous elements per k), narrow panels are zero padded. */
+		template<typename T, std::size_t NR>
+		void pack_b(std::size_t kc, std::size_t nc, T const* b, std::ptrdiff_t rsb, std::ptrdiff_t csb, T* packed)
+		{
+			for (std::size_t j = 0; j < nc; j += NR) {
+				std::size_t const cols = std::min(NR, nc - j);
+				T const* panel = b + static_cast<std::ptrdiff_t>(j) * csb;
+
+				for (std::size_t p = 0; p < kc; ++p) {
+					T const* row = panel + static_cast<std::ptrdiff_t>(p) * rsb;
+					std::size_t c = 0;
+
+					if (csb == 1) {
+						for (; c < cols; ++c) {
+							packed[c] = row[c];
+						}
+					}
+					else {
+						for (; c < cols; ++c) {
+							packed[c] = row[static_cast<std::ptrdiff_t>(c) * csb];
+						}
+					}
+					for (; c < NR; ++c) {
+						packed[c] = T{};
+					}
+
+					packed += NR;
+				}
+			}
+		}
+
+		/* Register-tiled micro-kernel.
+			Multiplies an mr x kc packed A micro-panel by a kc x nr packed B micro-panel.
+			The mr x nr accumulator tile is held in registers, only the top-left m x n corner is written to C,
+			as C = alpha AB + beta C. C is not read when `beta` is zero, so it may hold anything (even NaN). */
+		template<typename T, std::size_t MR, std::size_t NR>
+		void micro_kernel(std::size_t kc, T const* a, T const* b, std::size_t m, std::size_t n,
+			T alpha, T beta, T* c, std::ptrdiff_t rsc, std::ptrdiff_t csc)
+		{
+			T ab[MR][NR] = {};
+
+			for (std::size_t p = 0; p < kc; ++p) {
+				for (std::size_t i = 0; i < MR; ++i) {
+					T const a_ip = a[i];
+
+					for (std::size_t j = 0; j < NR; ++j) {
+						ab[i][j] += a_ip * b[j];
+					}
+				}
+
+				a += MR;
+				b += NR;
+			}
+
+			for (std::size_t i = 0; i < m; ++i) {
+				T* c_row = c + static_cast<std::ptrdiff_t>(i) * rsc;
+
+				for (std::size_t j = 0; j < n; ++j) {
+					T& c_ij = c_row[static_cast<std::ptrdiff_t>(j) * csc];
+					c_ij = beta == T{} ? alpha * ab[i][j] : beta * c_ij + alpha * ab[i][j];
+				}
+			}
+		}
+
+		/* Multiplies a packed mc x kc block of A by a packed kc x nc panel of B into C.
+			as C = alpha AB + beta C. Loops over the register tiles, B micro-panels outermost so each stays in L1 across the A block. */
+		template<typename T, std::size_t MR, std::size_t NR>
+		void macro_kernel(std::size_t mc, std::size_t nc, std::size_t kc, T const* packed_a, T const* packed_b,
+			T alpha, T beta, T* c, std::ptrdiff_t rsc, std::ptrdiff_t csc)
+		{
+			for (std::size_t j = 0; j < nc; j += NR) {
+				std::size_t const n = std::min(NR, nc - j);
+				T const* b = packed_b + j * kc;
+
+				for (std::size_t i = 0; i < mc; i += MR) {
+					std::size_t const m = std::min(MR, mc - i);
+					T const* a = packed_a + i * kc;
+					T* c_tile = c + static_cast<std::ptrdiff_t>(i) * rsc + static_cast<std::ptrdiff_t>(j) * csc;
+
+					micro_kernel<T, MR, NR>(kc, a, b, m, n, alpha, beta, c_tile, rsc, csc);
+				}
+			}
+		}
+
+		/* General matrix multiplication, C = alpha AB + beta C.
+			A is m x k, B is k x n and C is m x n. Each operand is addressed by a row stride and a column stride,
+			so any of them may be row major, column major or a strided submatrix.
+			The first panel of the depth is scaled into C by `beta`, later panels are added to it. C is not read when
+			`beta` is zero. C must not overlap A or B.
+			The packed panels of A and B are allocated from the calling thread's tc::workspace arena. */
+		template<typename T>
+		void gemm(std::size_t m, std::size_t n, std::size_t k, T alpha,
+			T const* a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+			T const* b, std::ptrdiff_t rsb, std::ptrdiff_t csb,
+			T beta, T* c, std::ptrdiff_t rsc, std::ptrdiff_t csc)
+		{
+			using block = blocking<T>;
+
+			if (m == 0 || n == 0) {
+				return;
+			}
+
+			if (k == 0) {
+				for (std::size_t i = 0; i < m; ++i) {
+					for (std::size_t j = 0; j < n; ++j) {
+						T& c_ij = c[static_cast<std::ptrdiff_t>(i) * rsc + static_cast<std::ptrdiff_t>(j) * csc];
+						c_ij = beta == T{} ? T{} : beta * c_ij;
+					}
+				}
+				return;
+			}
+
+			std::size_t const mc_max = std::min(block::mc, (m + block::mr - 1) / block::mr * block::mr);
+			std::size_t const nc_max = std::min(block::nc, (n + block::nr - 1) / block::nr * block::nr);
+			std::size_t const kc_max = std::min(block::kc, k);
+
+			tc::workspace::scope scratch;
+			T* const packed_a = scratch.allocate<T>(mc_max * kc_max);
+			T* const packed_b = scratch.allocate<T>(kc_max * nc_max);
+
+			for (std::size_t jc = 0; jc < n; jc += block::nc) {
+				std::size_t const nc = std::min(block::nc, n - jc);
+
+				for (std::size_t pc = 0; pc < k; pc += block::kc) {
+					std::size_t const kc = std::min(block::kc, k - pc);
+
+					pack_b<T, block::nr>(kc, nc,
+						b + static_cast<std::ptrdiff_t>(pc) * rsb + static_cast<std::ptrdiff_t>(jc) * csb, rsb, csb,
+						packed_b);
+
+					for (std::size_t ic = 0; ic < m; ic += block::mc) {
+						std::size_t const mc = std::min(block::mc, m - ic);
+
+						pack_a<T, block::mr>(mc, kc,
+							a + static_cast<std::ptrdiff_t>(ic) * rsa + static_cast<std::ptrdiff_t>(pc) * csa, rsa, csa,
+							packed_a);
+
+						macro_kernel<T, block::mr, block::nr>(mc, nc, kc, packed_a, packed_b,
+							alpha, pc == 0 ? beta : T{1},
+							c + static_cast<std::ptrdiff_t>(ic) * rsc + static_cast<std::ptrdiff_t>(jc) * csc, rsc, csc);
+					}
+				}
+			}
+		}
+
+		// General matrix multiplication, C = AB.
+		template<typename T>
+		void gemm(std::size_t m, std::size_t n, std::size_t k,
+			T const* a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+			T const* b, std::ptrdiff_t rsb, std::ptrdiff_t csb,
+			T* c, std::ptrdiff_t rsc, std::ptrdiff_t csc)
+		{
+			gemm<T>(m, n, k, T{1}, a, rsa, csa, b, rsb, csb, T{}, c, rsc, csc);
+		}
+
+
+		// Largest product (m n k) small_gemm is meant for, bigger products repay packing.
+		constexpr inline std::size_t small_limit = 64 * 64 * 64;
+
+		/* Register-tiled kernel reading its operands in place, without packing.
+			Computes an MR x NR tile of C = AB over the full depth k. Rows of B and C must be contiguous (column stride one).
+			With GCC and Clang the accumulator tile is held in SIMD vectors of simd_width elements and the tile loops are
+			unrolled explicitly: written as plain loops, -O3 vectorises the depth loop instead and leaves the tile in memory.
+			NR must be a multiple of simd_width. */
+		template<typename T, std::size_t MR, std::size_t NR>
+		void direct_kernel(std::size_t k, T const* a, std::ptrdiff_t rsa, std::ptrdiff_t csa, T const* b, std::ptrdiff_t rsb,
+			T* c, std::ptrdiff_t rsc)
+		{
+			#if defined(__GNUC__)
+				constexpr std::size_t w = simd_width<T>;
+				constexpr std::size_t nv = NR / w;
+				typedef T vector __attribute__((vector_size(w * sizeof(T))));
+
+				vector ab[MR][nv] = {};
+
+				for (std::size_t p = 0; p < k; ++p) {
+					T const* a_p = a + static_cast<std::ptrdiff_t>(p) * csa;
+					T const* b_p = b + static_cast<std::ptrdiff_t>(p) * rsb;
+					vector b_v[nv];
+
+					#pragma GCC unroll 8
+					for (std::size_t j = 0; j < nv; ++j) {
+						std::memcpy(&b_v[j], b_p + j * w, sizeof(vector));
+					}
+
+					#pragma GCC unroll 8
+					for (std::size_t i = 0; i < MR; ++i) {
+						T const a_ip = a_p[static_cast<std::ptrdiff_t>(i) * rsa];
+
+						#pragma GCC unroll 8
+						for (std::size_t j = 0; j < nv; ++j) {
+							ab[i][j] += a_ip * b_v[j];
+						}
+					}
+				}
+
+				for (std::size_t i = 0; i < MR; ++i) {
+					for (std::size_t j = 0; j < nv; ++j) {
+						std::memcpy(c + static_cast<std::ptrdiff_t>(i) * rsc + j * w, &ab[i][j], sizeof(vector));
+					}
+				}
+			#else
+				T ab[MR][NR] = {};
+
+				for (std::size_t p = 0; p < k; ++p) {
+					T const* a_p = a + static_cast<std::ptrdiff_t>(p) * csa;
+					T const* b_p = b + static_cast<std::ptrdiff_t>(p) * rsb;
+
+					for (std::size_t i = 0; i < MR; ++i) {
+						T const a_ip = a_p[static_cast<std::ptrdiff_t>(i) * rsa];
+
+						for (std::size_t j = 0; j < NR; ++j) {
+							ab[i][j] += a_ip * b_p[j];
+						}
+					}
+				}
+
+				for (std::size_t i = 0; i < MR; ++i) {
+					T* c_row = c + static_cast<std::ptrdiff_t>(i) * rsc;
+
+					for (std::size_t j = 0; j < NR; ++j) {
+						c_row[j] = ab[i][j];
+					}
+				}
+			#endif
+		}
+
+		/* General matrix multiplication of small matrices, C = AB, on the calling thread.
+			Same operands as gemm. For products up to small_limit the packing of gemm costs more than it saves, so
+			C is computed in 4 x nr register tiles straight from A and B, nr being one or two SIMD registers wide.
+			Needs B and C row major, or A and C column major (computed as the transposed product); other storage orders
+			go through gemm. Rows and columns left over from whole tiles are computed as dot products.
+			C must not overlap A or B. */
+		template<typename T>
+		void small_gemm(std::size_t m, std::size_t n, std::size_t k,
+			T const* a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+			T const* b, std::ptrdiff_t rsb, std::ptrdiff_t csb,
+			T* c, std::ptrdiff_t rsc, std::ptrdiff_t csc)
+		{
+			if (csb != 1 || csc != 1) {
+				if (rsa == 1 && rsc == 1) {
+					small_gemm<T>(n, m, k, b, csb, rsb, a, csa, rsa, c, csc, rsc);
+				}
+				else {
+					gemm<T>(m, n, k, a, rsa, csa, b, rsb, csb, c, rsc, csc);
+				}
+				return;
+			}
+
+			constexpr std::size_t mr = 4;
+			constexpr std::size_t nr = simd_width<T>;
+
+			auto const at = [](auto* x, std::ptrdiff_t rs, std::ptrdiff_t cs, std::size_t i, std::size_t j) {
+				return x + static_cast<std::ptrdiff_t>(i) * rs + static_cast<std::ptrdiff_t>(j) * cs;
+			};
+
+			std::size_t const m_whole = m / mr * mr;
+			std::size_t j = 0;
+
+			for (; j + 2 * nr <= n; j += 2 * nr) {
+				for (std::size_t i = 0; i < m_whole; i += mr) {
+					direct_kernel<T, mr, 2 * nr>(k, at(a, rsa, csa, i, 0), rsa, csa, at(b, rsb, 1, 0, j), rsb, at(c, rsc, 1, i, j), rsc);
+				}
+			}
+			for (; j + nr <= n; j += nr) {
+				for (std::size_t i = 0; i < m_whole; i += mr) {
+					direct_kernel<T, mr, nr>(k, at(a, rsa, csa, i, 0), rsa, csa, at(b, rsb, 1, 0, j), rsb, at(c, rsc, 1, i, j), rsc);
+				}
+			}
+
+			// Dot product for each element outside the whole tiles, ie in columns [j, n) or rows [m_whole, m).
+			for (std::size_t i = 0; i < m; ++i) {
+				for (std::size_t jj = (i < m_whole ? j : 0); jj < n; ++jj) {
+					T sum{};
+
+					for (std::size_t p = 0; p < k; ++p) {
+						sum += *at(a, rsa, csa, i, p) * *at(b, rsb, 1, p, jj);
+					}
+					*at(c, rsc, 1, i, jj) = sum;
+				}
+			}
+		}
+
+
+		// Epilogue of parallel_gemm that does nothing.
+		struct no_epilogue {
+			void operator()(std::size_t, std::size_t, std::size_t, std::size_t) const {}
+		};
+
+		/* Multi-threaded general matrix multiplication, C = alpha AB + beta C.
+			Same operands as gemm. C is split into tiles of whole register tiles which are scheduled on the
+			tc::parallel work-stealing pool, each tile is computed by gemm over the full depth.
+			Every element of C goes through the same sequence of operations as in the serial gemm,
+			so the result is bitwise identical for any thread count and tiling.
+			epilogue(i, j, rows, columns) is called on the thread that finished each tile of C, with the tile's first
+			row and column (0-indexed) and its size, so elementwise work on C can be done while the tile is in cache. */
+		template<typename T, typename Epilogue = no_epilogue>
+		void parallel_gemm(std::size_t m, std::size_t n, std::size_t k, T alpha,
+			T const* a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+			T const* b, std::ptrdiff_t rsb, std::ptrdiff_t csb,
+			T beta, T* c, std::ptrdiff_t rsc, std::ptrdiff_t csc,
+			Epilogue epilogue = {})
+		{
+			using block = blocking<T>;
+
+			// Below this many multiply-adds threading costs more than it saves.
+			constexpr std::size_t serial_limit = 64 * 64 * 64;
+
+			std::size_t const threads = tc::parallel::thread_count();
+
+			if (threads == 1 || m * n * k <= serial_limit) {
+				gemm<T>(m, n, k, alpha, a, rsa, csa, b, rsb, csb, beta, c, rsc, csc);
+				epilogue(0, 0, m, n);
+				return;
+			}
+
+			// Start from L2 sized tiles, then split until there are enough to keep every thread busy.
+			std::size_t const min_tiles = 4 * threads;
+			std::size_t tile_m = block::mc;
+			std::size_t tile_n = std::min(block::nc, 64 * block::nr);
+
+			auto tiles = [&]{ return ((m + tile_m - 1) / tile_m) * ((n + tile_n - 1) / tile_n); };
+
+			while (tiles() < min_tiles && (tile_n > 4 * block::nr || tile_m > block::mr)) {
+				if (tile_n > 4 * block::nr && (tile_n >= tile_m || tile_m <= block::mr)) {
+					tile_n = (tile_n / 2 + block::nr - 1) / block::nr * block::nr;
+				}
+				else {
+					tile_m = (tile_m / 2 + block::mr - 1) / block::mr * block::mr;
+				}
+			}
+
+			std::size_t const tile_rows = (m + tile_m - 1) / tile_m;
+
+			tc::parallel::for_each_task(tiles(), [&](std::size_t task) {
+				std::size_t const i = (task % tile_rows) * tile_m;
+				std::size_t const j = (task / tile_rows) * tile_n;
+
+				std::size_t const rows = std::min(tile_m, m - i);
+				std::size_t const columns = std::min(tile_n, n - j);
+
+				gemm<T>(rows, columns, k, alpha,
+					a + static_cast<std::ptrdiff_t>(i) * rsa, rsa, csa,
+					b + static_cast<std::ptrdiff_t>(j) * csb, rsb, csb,
+					beta, c + static_cast<std::ptrdiff_t>(i) * rsc + static_cast<std::ptrdiff_t>(j) * csc, rsc, csc);
+				epilogue(i, j, rows, columns);
+			});
+		}
+
+		// Multi-threaded general matrix multiplication, C = AB.
+		template<typename T, typename Epilogue = no_epilogue>
+		void parallel_gemm(std::size_t m, std::size_t n, std::size_t k,
+			T const* a, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+			T const* b, std::ptrdiff_t rsb, std::ptrdiff_t csb,
+			T* c, std::ptrdiff_t rsc, std::ptrdiff_t csc,
+			Epilogue epilogue = {})
+		{
+			parallel_gemm<T>(m, n, k, T{1}, a, rsa, csa, b, rsb, csb, T{}, c, rsc, csc, epilogue);
+		}
+
+	}
+}
@@ -0,0 +1,693 @@
+#pragma once
+
+#include <array>					// std::array
+#ifdef _DEBUG
+	#include <cassert>				// assert
+#endif
+#include <cerrno>					// errno
+#include <cstddef>					// std::byte, std::size_t
+#include <cstdint>					// std::int8_t, std::int16_t, std::int32_t, std::int64_t, std::uint8_t, std::uint16_t, std::uint32_t, std::uint64_t
+#include <cstring>					// std::memcmp, std::memcpy
+#include <limits>					// std::numeric_limits
+#include <stdexcept>				// std::runtime_error
+#include <string>					// std::string
+#include <system_error>				// std::generic_category, std::system_error
+#include <type_traits>				// std::integral_constant, std::is_const_v, std::remove_cv_t
+#include <utility>					// std::exchange, std::move, std::swap
+#include <vector>					// std::vector
+#include <fcntl.h>					// ::open, O_CLOEXEC, O_CREAT, O_RDONLY, O_RDWR, O_TRUNC
+#include <sys/mman.h>				// ::madvise, ::mmap, ::msync, ::munmap, MADV_*, MAP_FAILED, MAP_SHARED, MS_SYNC, PROT_READ, PROT_WRITE
+#include <sys/stat.h>				// ::fstat, struct stat
+#include <unistd.h>					// ::close, ::ftruncate, ::sysconf, _SC_PAGESIZE
+#include "array_ops.hpp"			// tc::array_ops::a_map
+#include "array_view.hpp"			// tc::array_view::array_view, tc::array_view::contiguous_strides, tc::array_view::dimensions
+#include "matrix_view.hpp"			// tc::matrix_view::column_major, tc::matrix_view::matrix_view, tc::matrix_view::row_major
+
+
+namespace tc {
+	namespace io {
+
+		/* Binary array files, mapped into memory and viewed in place.
+			A file is a header followed by the payload, the elements, at an offset aligned to payload_alignment:
+				magic			8 bytes, "TCARRAY" and a zero byte
+				version			std::uint32_t
+				byte_order		std::uint32_t, byte_order_mark as written, so files from a machine of the other endianness
+								are recognised and rejected
+				type			std::uint32_t, a dtype
+				rank			std::uint32_t, number of dimensions
+				payload_offset	std::uint64_t, bytes from the start of the file to the first element
+				payload_size	std::uint64_t, bytes of payload
+				dims			rank std::uint64_t, size of each dimension, outermost first
+				strides			rank std::uint64_t, elements between consecutive indices of each dimension
+			Integers are in the byte order of the machine that wrote the file. The writers below always store the payload
+			contiguously, but readers accept any strides that keep every element inside the payload.
+			Views point straight into the mapping, so pages are read from disk on first touch and shared with the page cache
+			rather than copied, and writes through a writable view go back to the file.
+			POSIX only (mmap). Errors from the system are thrown as std::system_error, malformed files and mismatched types
+			as std::runtime_error. */
+
+		// Element type of a file.
+		enum class dtype : std::uint32_t {
+			float32 = 1,
+			float64 = 2,
+			int8 = 3,
+			int16 = 4,
+			int32 = 5,
+			int64 = 6,
+			uint8 = 7,
+			uint16 = 8,
+			uint32 = 9,
+			uint64 = 10
+		};
+
+		// Access to a mapped file.
+		enum class access {
+			read_only,
+			read_write
+		};
+
+		// Access pattern hints for a mapping, passed to madvise.
+		enum class advice {
+			normal,
+			sequential,
+			random,
+			will_need,
+			dont_need
+		};
+
+		// Provides member constant `value`, the dtype of element type T. Undefined for unsupported types.
+		template<typename T>
+		struct dtype_of;
+
+		template<> struct dtype_of<float> : std::integral_constant<dtype, dtype::float32> {};
+		template<> struct dtype_of<double> : std::integral_constant<dtype, dtype::float64> {};
+		template<> struct dtype_of<std::int8_t> : std::integral_constant<dtype, dtype::int8> {};
+		template<> struct dtype_of<std::int16_t> : std::integral_constant<dtype, dtype::int16> {};
+		template<> struct dtype_of<std::int32_t> : std::integral_constant<dtype, dtype::int32> {};
+		template<> struct dtype_of<std::int64_t> : std::integral_constant<dtype, dtype::int64> {};
+		template<> struct dtype_of<std::uint8_t> : std::integral_constant<dtype, dtype::uint8> {};
+		template<> struct dtype_of<std::uint16_t> : std::integral_constant<dtype, dtype::uint16> {};
+		template<> struct dtype_of<std::uint32_t> : std::integral_constant<dtype, dtype::uint32> {};
+		template<> struct dtype_of<std::uint64_t> : std::integral_constant<dtype, dtype::uint64> {};
+
+		// The dtype of element type T, ignoring cv-qualifiers.
+		template<typename T>
+		constexpr inline dtype dtype_of_v = dtype_of<std::remove_cv_t<T>>::value;
+
+		// Identifies an array file, the first 8 bytes.
+		constexpr inline std::array<char, 8> magic{'T', 'C', 'A', 'R', 'R', 'A', 'Y', '\0'};
+
+		// Version of the format written.
+		constexpr inline std::uint32_t version = 1;
+
+		// Written as the byte_order field, reads back byte swapped on a machine of the other endianness.
+		constexpr inline std::uint32_t byte_order_mark = 0x01020304;
+
+		// Alignment in bytes of the payload in the file, and so in memory, a page on common systems.
+		constexpr inline std::size_t payload_alignment = 4096;
+
+		// Fixed part of the header, followed by the dims and strides.
+		struct header {
+			std::array<char, 8> magic;
+			std::uint32_t version;
+			std::uint32_t byte_order;
+			std::uint32_t type;
+			std::uint32_t rank;
+			std::uint64_t payload_offset;
+			std::uint64_t payload_size;
+		};
+
+		// Description of the array stored in a file, as read from its header.
+		struct array_info {
+			dtype type;
+			std::vector<std::size_t> dims;
+			std::vector<std::size_t> strides;
+			std::size_t payload_offset;
+			std::size_t payload_size;
+		};
+
+		// Gets the size in bytes of an element of type `type`, or zero if `type` is not a dtype.
+		constexpr std::size_t dtype_size(dtype type)
+		{
+			switch (type) {
+			case dtype::int8:
+			case dtype::uint8:
+				return 1;
+			case dtype::int16:
+			case dtype::uint16:
+				return 2;
+			case dtype::float32:
+			case dtype::int32:
+			case dtype::uint32:
+				return 4;
+			case dtype::float64:
+			case dtype::int64:
+			case dtype::uint64:
+				return 8;
+			}
+			return 0;
+		}
+
+		// Gets the offset of the payload in a file holding an array of rank `rank`, the header rounded up to payload_alignment.
+		constexpr std::size_t payload_offset(std::size_t rank)
+		{
+			return (sizeof(header) + 2 * rank * sizeof(std::uint64_t) + payload_alignment - 1) / payload_alignment * payload_alignment;
+		}
+
+
+		/* Owner of an open file descriptor, closed on destruction.
+			Throws std::system_error if the file cannot be opened. */
+		class file_descriptor {
+		public:
+
+			/* Special members */
+
+			// Destructor, closes the file.
+			~file_descriptor()
+			{
+				::close(_fd);
+			}
+
+			// Constructor opening `path` with open(2) `flags`, creating it if O_CREAT is set.
+			file_descriptor(std::string const& path, int flags) :
+				_fd{::open(path.c_str(), flags | O_CLOEXEC, 0644)}
+			{
+				if (_fd < 0) {
+					throw std::system_error{errno, std::generic_category(), "tc::io: cannot open " + path};
+				}
+			}
+
+			// Copy constructor - deleted, file descriptors are owned.
+			file_descriptor(file_descriptor const&) = delete;
+
+
+			/* Operators */
+
+			// Simple assignment - copy - deleted, file descriptors are owned.
+			file_descriptor& operator=(file_descriptor const&) = delete;
+
+
+			/* General member functions */
+
+			// Gets the file descriptor.
+			int get() const
+			{
+				return _fd;
+			}
+
+
+		private:
+
+			/* Member variables */
+
+			// Open file descriptor.
+			int _fd;
+		};
+
+
+		/* Shared memory map of a whole file, unmapped on destruction.
+			Pointers into the mapping stay valid while it lives, the file itself need not stay open. */
+		class mapping {
+		public:
+
+			/* Member type aliases */
+
+			using size_type = std::size_t;
+
+
+			/* Special members */
+
+			// Destructor, unmaps the file. Changes to a writable mapping reach the file, see flush to wait for them.
+			~mapping()
+			{
+				if (_data) {
+					::munmap(_data, _size);
+				}
+			}
+
+			// Default constructor, no mapping.
+			mapping() :
+				_data{nullptr},
+				_size{0}
+			{}
+
+			// Constructor mapping the existing file `path` with access `mode`.
+			mapping(std::string const& path, access mode) :
+				mapping{}
+			{
+				bool const writable = mode == access::read_write;
+				file_descriptor const file{path, writable ? O_RDWR : O_RDONLY};
+				struct stat status;
+
+				if (::fstat(file.get(), &status) != 0) {
+					throw std::system_error{errno, std::generic_category(), "tc::io: cannot stat " + path};
+				}
+				map(file, static_cast<size_type>(status.st_size), writable, path);
+			}
+
+			// Constructor creating (or truncating) file `path` with `size` zero bytes and mapping it writable.
+			mapping(std::string const& path, size_type size) :
+				mapping{}
+			{
+				file_descriptor const file{path, O_RDWR | O_CREAT | O_TRUNC};
+
+				if (::ftruncate(file.get(), static_cast<off_t>(size)) != 0) {
+					throw std::system_error{errno, std::generic_category(), "tc::io: cannot resize " + path};
+				}
+				map(file, size, true, path);
+			}
+
+			// Copy constructor - deleted, mappings are owned.
+			mapping(mapping const&) = delete;
+
+			// Move constructor, `other` is left with no mapping.
+			mapping(mapping&& other) noexcept :
+				_data{std::exchange(other._data, nullptr)},
+				_size{std::exchange(other._size, 0)}
+			{}
+
+
+			/* Operators */
+
+			// Simple assignment - copy - deleted, mappings are owned.
+			mapping& operator=(mapping const&) = delete;
+
+			// Simple assignment - move, the mapping held before is unmapped.
+			mapping& operator=(mapping&& other) noexcept
+			{
+				mapping old{std::move(other)};
+
+				std::swap(_data, old._data);
+				std::swap(_size, old._size);
+				return *this;
+			}
+
+
+			/* General member functions */
+
+			// Hints the access pattern for the whole mapping.
+			void advise(advice hint) const
+			{
+				advise(hint, 0, _size);
+			}
+
+			/* Hints the access pattern for `length` bytes from `offset`. The range is widened to whole pages.
+				Hints are advisory, failures are ignored. */
+			void advise(advice hint, size_type offset, size_type length) const
+			{
+				#ifdef _DEBUG
+					assert(offset <= _size && length <= _size - offset);
+				#endif
+
+				if (length == 0) {
+					return;
+				}
+
+				int const flags[] = {MADV_NORMAL, MADV_SEQUENTIAL, MADV_RANDOM, MADV_WILLNEED, MADV_DONTNEED};
+				size_type const page = static_cast<size_type>(::sysconf(_SC_PAGESIZE));
+				size_type const begin = offset / page * page;
+
+				::madvise(_data + begin, offset + length - begin, flags[static_cast<int>(hint)]);
+			}
+
+			// Gets the pointer to the first byte.
+			std::byte* data() const
+			{
+				return _data;
+			}
+
+			/* Writes changes back to the file, returning once they are on disk.
+				Throws std::system_error on failure. */
+			void flush() const
+			{
+				if (_data && ::msync(_data, _size, MS_SYNC) != 0) {
+					throw std::system_error{errno, std::generic_category(), "tc::io: cannot flush mapping"};
+				}
+			}
+
+			// Gets the size in bytes.
+			size_type size() const
+			{
+				return _size;
+			}
+
+
+		private:
+
+			/* General member functions */
+
+			// Maps the first `size` bytes of `file`.
+			void map(file_descriptor const& file, size_type size, bool writable, std::string const& path)
+			{
+				if (size == 0) {
+					return;
+				}
+
+				void* const p = ::mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, file.get(), 0);
+
+				if (p == MAP_FAILED) {
+					throw std::system_error{errno, std::generic_category(), "tc::io: cannot map " + path};
+				}
+				_data = static_cast<std::byte*>(p);
+				_size = size;
+			}
+
+
+			/* Member variables */
+
+			// Pointer to the first byte, nullptr if nothing is mapped.
+			std::byte* _data;
+
+			// Size in bytes.
+			size_type _size;
+		};
+
+
+		/* A view into a mapped file, together with the mapping that keeps it valid.
+			Copies of the view are only valid while this object lives. */
+		template<class View>
+		class mapped {
+		public:
+
+			/* Member type aliases */
+
+			using view_type = View;
+
+
+			/* Special members */
+
+			// Destructor, unmaps the file.
+			~mapped() = default;
+
+			// Constructor from mapping and a view into it.
+			mapped(mapping&& file, view_type const& view) :
+				_mapping{std::move(file)},
+				_view{view}
+			{}
+
+			// Copy constructor - deleted, mappings are owned.
+			mapped(mapped const&) = delete;
+
+			// Move constructor, views into the mapping stay valid.
+			mapped(mapped&&) = default;
+
+
+			/* Operators */
+
+			// Simple assignment - copy - deleted, mappings are owned.
+			mapped& operator=(mapped const&) = delete;
+
+			// Simple assignment - move, the mapping held before is unmapped.
+			mapped& operator=(mapped&&) = default;
+
+			// Member access - the view.
+			view_type const* operator->() const
+			{
+				return &_view;
+			}
+
+
+			/* General member functions */
+
+			// Hints the access pattern for the whole file.
+			void advise(advice hint) const
+			{
+				_mapping.advise(hint);
+			}
+
+			// Gets the mapping.
+			mapping const& file() const
+			{
+				return _mapping;
+			}
+
+			/* Writes changes back to the file, returning once they are on disk.
+				Throws std::system_error on failure. */
+			void flush() const
+			{
+				_mapping.flush();
+			}
+
+			// Gets the view.
+			view_type const& view() const
+			{
+				return _view;
+			}
+
+
+		private:
+
+			/* Member variables */
+
+			// Mapping of the file.
+			mapping _mapping;
+
+			// View of the payload.
+			view_type _view;
+		};
+
+
+		/* Reads and checks the header of a mapped array file.
+			Throws std::runtime_error if it is not an array file of a supported version written with this byte order, or if
+			its elements do not all lie inside the payload and the payload inside the file. */
+		inline array_info read_info(mapping const& file)
+		{
+			auto const fail = [](char const* what) {
+				throw std::runtime_error{std::string{"tc::io: "} + what};
+			};
+
+			header head;
+
+			if (file.size() < sizeof(head)) {
+				fail("not an array file");
+			}
+			std::memcpy(&head, file.data(), sizeof(head));
+
+			if (std::memcmp(head.magic.data(), magic.data(), magic.size()) != 0) {
+				fail("not an array file");
+			}
+			if (head.byte_order != byte_order_mark) {
+				fail("array file of the other byte order");
+			}
+			if (head.version != version) {
+				fail("unsupported array file version");
+			}
+
+			array_info info{static_cast<dtype>(head.type), {}, {}, 0, 0};
+			std::size_t const element_size = dtype_size(info.type);
+			std::size_t const rank = head.rank;
+
+			if (element_size == 0) {
+				fail("unknown element type");
+			}
+			if (rank == 0 || rank > (file.size() - sizeof(head)) / (2 * sizeof(std::uint64_t))) {
+				fail("bad rank");
+			}
+			if (head.payload_offset < sizeof(head) + 2 * rank * sizeof(std::uint64_t) || head.payload_offset % payload_alignment != 0
+				|| head.payload_offset > file.size() || head.payload_size > file.size() - head.payload_offset) {
+				fail("payload outside the file");
+			}
+			info.payload_offset = static_cast<std::size_t>(head.payload_offset);
+			info.payload_size = static_cast<std::size_t>(head.payload_size);
+			info.dims.resize(rank);
+			info.strides.resize(rank);
+
+			for (std::size_t d = 0; d < rank; ++d) {
+				std::uint64_t values[2];
+
+				std::memcpy(values, file.data() + sizeof(head) + d * sizeof(std::uint64_t), sizeof(std::uint64_t));
+				std::memcpy(values + 1, file.data() + sizeof(head) + (rank + d) * sizeof(std::uint64_t), sizeof(std::uint64_t));
+				info.dims[d] = static_cast<std::size_t>(values[0]);
+				info.strides[d] = static_cast<std::size_t>(values[1]);
+			}
+
+			// Offset of the last element, checking for overflow. Empty arrays have no elements to check.
+			std::size_t const limit = info.payload_size / element_size;
+			std::size_t last = 0;
+
+			for (std::size_t d = 0; d < rank; ++d) {
+				if (info.dims[d] == 0) {
+					return info;
+				}
+
+				std::size_t const reach = info.dims[d] - 1;
+
+				if (info.strides[d] != 0 && reach > (std::numeric_limits<std::size_t>::max() - last) / info.strides[d]) {
+					fail("elements outside the payload");
+				}
+				last += reach * info.strides[d];
+			}
+			if (last >= limit) {
+				fail("elements outside the payload");
+			}
+			return info;
+		}
+
+		/* Reads and checks the header of mapped array file `path`, as read_info, and that it holds elements of type T in
+			`rank` dimensions. Throws std::runtime_error if not. */
+		template<typename T>
+		array_info read_info(mapping const& file, std::size_t rank, std::string const& path)
+		{
+			array_info info = read_info(file);
+
+			if (info.type != dtype_of_v<T>) {
+				throw std::runtime_error{"tc::io: element type mismatch in " + path};
+			}
+			if (info.dims.size() != rank) {
+				throw std::runtime_error{"tc::io: rank mismatch in " + path};
+			}
+			return info;
+		}
+
+		/* Creates (or truncates) file `path` for a contiguous array of dimensions `dims` and writes its header.
+			Returns the mapping, writable, with the payload zeroed. */
+		template<typename T, std::size_t N>
+		mapping create_file(std::string const& path, tc::array_view::dimensions<N> const& dims)
+		{
+			static_assert(N > 0, "files hold arrays of known rank");
+
+			auto const strides = tc::array_view::contiguous_strides<N, std::size_t>(dims);
+			std::size_t elements = 1;
+
+			for (std::size_t d = 0; d < N; ++d) {
+				elements *= dims[d];
+			}
+
+			header const head{magic, version, byte_order_mark, static_cast<std::uint32_t>(dtype_of_v<T>), static_cast<std::uint32_t>(N),
+				payload_offset(N), elements * sizeof(T)};
+
+			mapping file{path, payload_offset(N) + elements * sizeof(T)};
+
+			std::memcpy(file.data(), &head, sizeof(head));
+
+			for (std::size_t d = 0; d < N; ++d) {
+				std::uint64_t const values[2]{dims[d], strides[d]};
+
+				std::memcpy(file.data() + sizeof(head) + d * sizeof(std::uint64_t), values, sizeof(std::uint64_t));
+				std::memcpy(file.data() + sizeof(head) + (N + d) * sizeof(std::uint64_t), values + 1, sizeof(std::uint64_t));
+			}
+			return file;
+		}
+
+
+		/* Maps array file `path` and views its elements in place as an N dimensional array of T, with the file's strides.
+			T const maps the file read-only, T writable, so assignments through the view change the file.
+			Throws std::runtime_error if the file's element type is not T or its rank is not N. */
+		template<typename T, std::size_t N>
+		mapped<tc::array_view::array_view<T, N>> map_array(std::string const& path, advice hint = advice::normal)
+		{
+			static_assert(N > 0, "files hold arrays of known rank");
+
+			mapping file{path, std::is_const_v<T> ? access::read_only : access::read_write};
+			array_info const info = read_info<T>(file, N, path);
+			tc::array_view::dimensions<N> dims;
+			tc::array_view::dimensions<N> strides;
+
+			for (std::size_t d = 0; d < N; ++d) {
+				dims[d] = info.dims[d];
+				strides[d] = info.strides[d];
+			}
+
+			file.advise(hint);
+
+			T* const data = reinterpret_cast<T*>(file.data() + info.payload_offset);
+
+			return {std::move(file), tc::array_view::array_view<T, N>{data, dims, strides}};
+		}
+
+		/* Maps matrix file `path`, a rank 2 array file, and views its elements in place as a matrix of T.
+			Rows (row major) or columns (column major) must be contiguous in the file, the other stride becomes the view's
+			stride. T const maps the file read-only, T writable, so assignments through the view change the file.
+			Throws std::runtime_error if the file's element type is not T, its rank is not 2 or its strides do not fit `Layout`. */
+		template<typename T, typename Layout = tc::matrix_view::row_major>
+		mapped<tc::matrix_view::matrix_view<T, Layout>> map_matrix(std::string const& path, advice hint = advice::normal)
+		{
+			using view_type = tc::matrix_view::matrix_view<T, Layout>;
+
+			mapping file{path, std::is_const_v<T> ? access::read_only : access::read_write};
+			array_info const info = read_info<T>(file, 2, path);
+
+			// Outer and inner dimensions in the view's storage order.
+			std::size_t const outer = view_type::is_row_major ? 0 : 1;
+			std::size_t const inner = 1 - outer;
+
+			if ((info.dims[inner] > 1 && info.strides[inner] != 1) || (info.dims[outer] > 1 && info.strides[outer] < info.dims[inner])) {
+				throw std::runtime_error{"tc::io: matrix layout mismatch in " + path};
+			}
+
+			file.advise(hint);
+
+			T* const data = reinterpret_cast<T*>(file.data() + info.payload_offset);
+			std::size_t const stride = info.dims[outer] > 1 ? info.strides[outer] : info.dims[inner];
+
+			return {std::move(file), view_type{data, info.dims[0], info.dims[1], stride}};
+		}
+
+		/* Creates (or truncates) array file `path` for a contiguous array of T of dimensions `dims`, and maps it for writing.
+			The elements start at zero. The default hint suits filling the array in order. */
+		template<typename T, std::size_t N>
+		mapped<tc::array_view::array_view<T, N>> create_array(std::string const& path, tc::array_view::dimensions<N> const& dims, advice hint = advice::sequential)
+		{
+			mapping file = create_file<T, N>(path, dims);
+
+			file.advise(hint);
+
+			T* const data = reinterpret_cast<T*>(file.data() + payload_offset(N));
+
+			return {std::move(file), tc::array_view::array_view<T, N>{data, dims}};
+		}
+
+		/* Creates (or truncates) matrix file `path` for a contiguous `rows` by `columns` matrix of T stored in `Layout`, and
+			maps it for writing. The elements start at zero. The default hint suits filling the matrix in order. */
+		template<typename T, typename Layout = tc::matrix_view::row_major>
+		mapped<tc::matrix_view::matrix_view<T, Layout>> create_matrix(std::string const& path, std::size_t rows, std::size_t columns, advice hint = advice::sequential)
+		{
+			using view_type = tc::matrix_view::matrix_view<T, Layout>;
+
+			mapping file = create_file<T, 2>(path, {rows, columns});
+
+			// create_file writes row major strides, column major ones are {1, rows}.
+			if constexpr (!view_type::is_row_major) {
+				std::uint64_t const strides[2]{1, rows};
+
+				std::memcpy(file.data() + sizeof(header) + 2 * sizeof(std::uint64_t), strides, sizeof(strides));
+			}
+
+			file.advise(hint);
+
+			T* const data = reinterpret_cast<T*>(file.data() + payload_offset(2));
+
+			return {std::move(file), view_type{data, rows, columns}};
+		}
+
+		/* Writes `in`, an array of any layout, to array file `path`, stored contiguously.
+			The copy is split across threads (see tc::array_ops::a_map). */
+		template<class InputArray>
+		void write_array(std::string const& path, InputArray const& in)
+		{
+			using value_type = typename InputArray::value_type;
+
+			auto const file = create_array<value_type, tc::array_ops::rank_v<InputArray>>(path, in.dim_sizes());
+			auto result = file.view();
+
+			tc::array_ops::a_map(result, [](value_type x) { return x; }, in);
+		}
+
+		/* Writes matrix `in` to matrix file `path`, stored contiguously in the same layout.
+			The copy is split across threads (see tc::array_ops::a_map). */
+		template<typename T, typename Layout>
+		void write_matrix(std::string const& path, tc::matrix_view::matrix_view<T, Layout> const& in)
+		{
+			using value_type = std::remove_cv_t<T>;
+
+			auto const file = create_matrix<value_type, Layout>(path, in.rows(), in.columns());
+			auto const& out = file.view();
+
+			tc::array_view::array_view<value_type const, 2> const source{in.data(), {in.rows(), in.columns()}, {in.row_stride(), in.column_stride()}};
+			tc::array_view::array_view<value_type, 2> result{out.data(), {out.rows(), out.columns()}, {out.row_stride(), out.column_stride()}};
+
+			tc::array_ops::a_map(result, [](value_type x) { return x; }, source);
+		}
+
+	}
+}
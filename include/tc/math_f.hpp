@@ -0,0 +1,522 @@
+#pragma once
+
+#include <algorithm>		// std::copy_n, std::min
+#include <array>			// std::array
+#include <cmath>			// std::abs, std::copysign
+#include <cstddef>			// std::size_t
+#include <cstdint>			// std::uint32_t, std::uint64_t
+#include <cstring>			// std::memcpy
+#include <limits>			// std::numeric_limits
+#include <type_traits>		// std::enable_if_t, std::false_type, std::is_floating_point_v, std::is_same_v, std::true_type, std::void_t
+#include <utility>			// std::declval
+#include "math.hpp"			// tc::math::sigmoid, tc::math::sigmoid_deriv
+
+
+namespace tc {
+	namespace math_f {
+
+		/* Branchless elementwise kernels for float and double.
+			Each kernel is a range reduction and a polynomial with no branches or table lookups, and makes its selections with
+			bit masks (see select), so loops over them (the batch functions below, or any loop calling them) can be vectorised
+			by the compiler. That needs SIMD comparisons of integers as wide as the type: SSE2 on x86 for float, SSE4.2 for
+			double (the x86-64 baseline is SSE2 only, so the double kernels run one element at a time there). The kernels
+			only beat the standard library functions with 256 bit integer vectors (AVX2), see replaces_math.
+			Largest errors seen, in units in the last place of the exact result, over 20 million random inputs per kernel and
+			type against long double references (test/accuracy_test.cpp). The error depends on whether the compiler fuses
+			the multiply-adds of the polynomials, which it does when targeting FMA (eg -march=native on recent x86):
+								float, FMA	float, no FMA	double, FMA	double, no FMA
+				exp				0.92		1.22			0.89		1.17
+				log				0.76		0.78			0.76		0.75
+				tanh			3.18		3.19			3.33		3.33
+				sigmoid			2.32		2.30			2.16		2.38
+				sigmoid_deriv	2.36		3.16			2.43		3.33
+			The sweep checks these against bounds of 1 ulp for exp (1.5 ulp without FMA) and log, 3.5 ulp for tanh, 2.5 ulp
+			for sigmoid and 2.5 ulp for sigmoid_deriv (3.5 ulp without FMA).
+			exp results in the subnormal range are rounded correctly rather than flushed to zero.
+			NaN inputs give NaN, infinities and zero give the correctly signed limits.
+			Results are the same for every element position, so batch results do not depend on how a range is split. */
+
+		// Bit layout of the supported floating point types.
+		template<typename T>
+		struct float_traits;
+
+		// Bit layout of double.
+		template<>
+		struct float_traits<double> {
+			using bits_type = std::uint64_t;
+
+			static constexpr int mantissa_bits = 52;
+			static constexpr bits_type bias = 1023;
+
+			// 1.5 * 2^52, adding and subtracting it rounds a double to the nearest integer.
+			static constexpr double round_magic = 6755399441055744.0;
+
+			// ln(2) split so that n * ln2_hi is exact for |n| < 2^11.
+			static constexpr double ln2_hi = 6.93147180369123816490e-01;
+			static constexpr double ln2_lo = 1.90821492927058770002e-10;
+
+			// Smallest and largest arguments of exp that do not round to zero or infinity.
+			static constexpr double exp_min = -746.0;
+			static constexpr double exp_max = 709.8;
+
+			// Argument beyond which tanh(x) rounds to +-1.
+			static constexpr double tanh_max = 20.0;
+
+			// Taylor terms of e^r - 1 used for |r| <= ln(2) / 2.
+			static constexpr std::size_t expm1_terms = 13;
+
+			// Terms of the atanh series used for log.
+			static constexpr std::size_t log_terms = 11;
+		};
+
+		// Bit layout of float.
+		template<>
+		struct float_traits<float> {
+			using bits_type = std::uint32_t;
+
+			static constexpr int mantissa_bits = 23;
+			static constexpr bits_type bias = 127;
+
+			// 1.5 * 2^23, adding and subtracting it rounds a float to the nearest integer.
+			static constexpr float round_magic = 12582912.0f;
+
+			// ln(2) split so that n * ln2_hi is exact for |n| < 2^8.
+			static constexpr float ln2_hi = 6.93145751953125e-01f;
+			static constexpr float ln2_lo = 1.42860676533018704e-06f;
+
+			// Smallest and largest arguments of exp that do not round to zero or infinity.
+			static constexpr float exp_min = -105.0f;
+			static constexpr float exp_max = 88.8f;
+
+			// Argument beyond which tanh(x) rounds to +-1.
+			static constexpr float tanh_max = 10.0f;
+
+			// Taylor terms of e^r - 1 used for |r| <= ln(2) / 2.
+			static constexpr std::size_t expm1_terms = 7;
+
+			// Terms of the atanh series used for log.
+			static constexpr std::size_t log_terms = 5;
+		};
+
+		// Reinterprets the bits of a float or double as an unsigned integer.
+		template<typename T>
+		inline typename float_traits<T>::bits_type to_bits(T x)
+		{
+			typename float_traits<T>::bits_type bits;
+			std::memcpy(&bits, &x, sizeof(x));
+			return bits;
+		}
+
+		// Reinterprets the bits of an unsigned integer as a float or double.
+		template<typename T>
+		inline T from_bits(typename float_traits<T>::bits_type bits)
+		{
+			T x;
+			std::memcpy(&x, &bits, sizeof(x));
+			return x;
+		}
+
+		/* Gets `condition ? if_true : if_false` by masking the bits of both values.
+			A ?: on floating point values can be turned into a branch, after which the compiler specialises the code on
+			each side of it and will not vectorise the loop (it may not evaluate floating point operations speculatively,
+			as they could raise exceptions). Masks only need SIMD integer operations as wide as T. */
+		template<typename T>
+		inline T select(bool condition, T if_true, T if_false)
+		{
+			using bits_type = typename float_traits<T>::bits_type;
+
+			bits_type const mask = bits_type{0} - static_cast<bits_type>(condition);
+			return from_bits<T>((to_bits(if_true) & mask) | (to_bits(if_false) & ~mask));
+		}
+
+		// Rounds to the nearest integer (ties to even), for |x| < 2^22.
+		template<typename T>
+		inline T round(T x)
+		{
+			return (x + float_traits<T>::round_magic) - float_traits<T>::round_magic;
+		}
+
+		// 2^k for an integer valued `k` in the normal exponent range.
+		template<typename T>
+		inline T pow2(T k)
+		{
+			using traits = float_traits<T>;
+
+			auto const n = to_bits(k + traits::round_magic) - to_bits(traits::round_magic);
+			return from_bits<T>((n + traits::bias) << traits::mantissa_bits);
+		}
+
+		// Coefficients c[i] = 1 / (i + 1)!, the Taylor series of e^r - 1.
+		template<typename T>
+		constexpr std::array<T, float_traits<T>::expm1_terms> expm1_coefficients = []() {
+			std::array<T, float_traits<T>::expm1_terms> c{};
+			double factorial = 1;
+
+			for (std::size_t i = 0; i < c.size(); ++i) {
+				factorial *= static_cast<double>(i + 1);
+				c[i] = static_cast<T>(1 / factorial);
+			}
+			return c;
+		}();
+
+		// Coefficients c[i] = 2 / (2i + 3), the series of (2 atanh(s) - 2s) / s^3 in s^2.
+		template<typename T>
+		constexpr std::array<T, float_traits<T>::log_terms> log_coefficients = []() {
+			std::array<T, float_traits<T>::log_terms> c{};
+
+			for (std::size_t i = 0; i < c.size(); ++i) {
+				c[i] = static_cast<T>(2.0 / static_cast<double>(2 * i + 3));
+			}
+			return c;
+		}();
+
+		// Evaluates c[0] + c[1] x + ... + c[N - 1] x^(N - 1) by Horner's rule, unrolled at compile time.
+		template<typename T, std::size_t N, std::size_t I = 0>
+		inline T polynomial(T x, std::array<T, N> const& c)
+		{
+			if constexpr (I + 1 == N) {
+				return c[I];
+			}
+			else {
+				return polynomial<T, N, I + 1>(x, c) * x + c[I];
+			}
+		}
+
+		/* Splits x into n ln(2) + r with integer n and |r| <= ln(2) / 2, returns e^r - 1 and sets n.
+			e^r - 1 is computed directly so it keeps full relative precision for small r. */
+		template<typename T>
+		inline T expm1_reduced(T x, T& n)
+		{
+			using traits = float_traits<T>;
+
+			n = round(x * T{1.44269504088896340736});
+
+			T const r = (x - n * traits::ln2_hi) - n * traits::ln2_lo;
+			return r * polynomial(r, expm1_coefficients<T>);
+		}
+
+		// e^x.
+		template<typename T>
+		inline std::enable_if_t<std::is_floating_point_v<T>, T> exp(T x)
+		{
+			using traits = float_traits<T>;
+
+			T const above_min = select(x < traits::exp_min, traits::exp_min, x);
+			T const clamped = select(above_min > traits::exp_max, traits::exp_max, above_min);
+			T n;
+			T const q = expm1_reduced(clamped, n);
+
+			// 2^n is applied in two halves so that results near overflow and in the subnormal range are rounded correctly.
+			T const half = round(n * T{0.5});
+			T const y = ((T{1} + q) * pow2(half)) * pow2(n - half);
+
+			return select(x != x, x, y);
+		}
+
+		// e^x - 1 for x <= `limit` (larger x are clamped to it), accurate for small |x|.
+		template<typename T>
+		inline T expm1_clamped(T x, T limit)
+		{
+			T const clamped = select(x > limit, limit, x);
+			T n;
+			T const q = expm1_reduced(clamped, n);
+			T const scale = pow2(n);
+
+			return scale * q + (scale - T{1});
+		}
+
+		// Natural logarithm.
+		template<typename T>
+		inline std::enable_if_t<std::is_floating_point_v<T>, T> log(T x)
+		{
+			using traits = float_traits<T>;
+			using bits_type = typename traits::bits_type;
+
+			constexpr bits_type mantissa_mask = (bits_type{1} << traits::mantissa_bits) - 1;
+			constexpr int subnormal_shift = traits::mantissa_bits + 2;
+			constexpr T subnormal_scale = T{1} * (std::uint64_t{1} << subnormal_shift);
+
+			// Subnormal inputs are scaled into the normal range first.
+			bool const subnormal = x < std::numeric_limits<T>::min();
+			T const scaled = select(subnormal, x * subnormal_scale, x);
+			bits_type const bits = to_bits(scaled);
+
+			// x = m 2^e, 1 <= m < 2.
+			T const biased_e = from_bits<T>(to_bits(traits::round_magic) + (bits >> traits::mantissa_bits)) - traits::round_magic;
+			T e = biased_e - static_cast<T>(traits::bias) - select(subnormal, static_cast<T>(subnormal_shift), T{0});
+			T m = from_bits<T>((bits & mantissa_mask) | to_bits(T{1}));
+
+			// Recentre to sqrt(1/2) <= m < sqrt(2).
+			bool const high = m > T{1.41421356237309504880};
+			m = select(high, m * T{0.5}, m);
+			e = select(high, e + T{1}, e);
+
+			// log(m) = log(1 + f) = 2 atanh(s), s = f / (2 + f), |s| <= 0.172, arranged so the large terms are exact.
+			T const f = m - T{1};
+			T const z = f / (T{2} + f);
+			T const w = z * z;
+			T const half_f2 = T{0.5} * f * f;
+			T const r = w * polynomial(w, log_coefficients<T>);
+			T const y = e * traits::ln2_hi + (f - (half_f2 - (z * (half_f2 + r) + e * traits::ln2_lo)));
+
+			constexpr T infinity = std::numeric_limits<T>::infinity();
+			constexpr T nan = std::numeric_limits<T>::quiet_NaN();
+
+			T const special = select(x == T{0}, -infinity, select(x != x, x, nan));
+
+			return select(x > T{0}, select(x < infinity, y, x), special);
+		}
+
+		// Hyperbolic tangent.
+		template<typename T>
+		inline std::enable_if_t<std::is_floating_point_v<T>, T> tanh(T x)
+		{
+			// tanh(|x|) = e / (e + 2), e = e^2|x| - 1.
+			T const e = expm1_clamped(T{2} * std::abs(x), T{2} * float_traits<T>::tanh_max);
+			T const y = std::copysign(e / (e + T{2}), x);
+
+			return select(x != x, x, y);
+		}
+
+		/* 1 / (1 + e) for 0 <= e <= 1.
+			The rounding error of 1 + e is recovered exactly and folded back in, so the result is within an ulp. */
+		template<typename T>
+		inline T inverse_one_plus(T e)
+		{
+			T const t = T{1} + e;
+			T const error = e - (t - T{1});
+			T const inverse = T{1} / t;
+
+			return inverse - inverse * (error * inverse);
+		}
+
+		// Sigmoid function (1 / (1 + e^-x)).
+		template<typename T>
+		inline std::enable_if_t<std::is_floating_point_v<T>, T> sigmoid(T x)
+		{
+			// e = e^-|x| never overflows, sigmoid(-|x|) = e / (1 + e).
+			T const e = exp(-std::abs(x));
+			T const inverse = inverse_one_plus(e);
+
+			return select(x >= T{0}, inverse, select(x != x, x, e * inverse));
+		}
+
+		/* e / (1 + e)^2 for 0 <= e <= 1.
+			As in inverse_one_plus, the rounding error of 1 + e is recovered and folded into the square. */
+		template<typename T>
+		inline T over_one_plus_squared(T e)
+		{
+			T const t = T{1} + e;
+			T const error = e - (t - T{1});
+
+			return e / (t * t + T{2} * t * error);
+		}
+
+		// Derivative of the sigmoid function (e^-x / (1 + e^-x)^2).
+		template<typename T>
+		inline std::enable_if_t<std::is_floating_point_v<T>, T> sigmoid_deriv(T x)
+		{
+			// The derivative is even, e^-|x| never overflows.
+			return over_one_plus_squared(exp(-std::abs(x)));
+		}
+
+		// Sigmoid function and its derivative from a single exponential.
+		template<typename T>
+		inline std::enable_if_t<std::is_floating_point_v<T>> sigmoid_with_deriv(T x, T& sigmoid, T& deriv)
+		{
+			T const e = exp(-std::abs(x));
+			T const inverse = inverse_one_plus(e);
+
+			sigmoid = select(x >= T{0}, inverse, select(x != x, x, e * inverse));
+			deriv = over_one_plus_squared(e);
+		}
+
+
+		/* Batch functions over contiguous ranges.
+			Each computes out[i] = f(in[i]) for i < n on the calling thread, `in` and `out` may be the same array.
+			tc::matrix_ops_f::m_fn and tc::vector_ops_f::v_fn split large ranges across threads and call these when given
+			one of the elementwise functions of tc::math_f, or of tc::math if replaces_math. */
+
+		// Elements per block of a batch, one cache line.
+		template<typename T>
+		constexpr inline std::size_t batch_block = 64 / sizeof(T);
+
+		/* Applies an elementwise kernel to a range, a block at a time.
+			The fixed length block loop is vectorised without aliasing checks or remainder handling: each element is read
+			before it is written, so `in` and `out` may be the same array but not otherwise overlap. The last partial block
+			is staged through local arrays, so there is a single call of the kernel, which is inlined whatever its size:
+			a call left in the loop would keep it from being vectorised. */
+		template<typename T, typename Kernel>
+		[[gnu::flatten]] void apply(T const* in, std::size_t n, T* out, Kernel kernel)
+		{
+			constexpr std::size_t block = batch_block<T>;
+
+			T x[block] = {};
+			T y[block];
+
+			for (std::size_t i = 0; i < n; i += block) {
+				std::size_t const count = std::min(block, n - i);
+				T const* const source = count == block ? in + i : x;
+				T* const target = count == block ? out + i : y;
+
+				if (count < block) {
+					std::copy_n(in + i, count, x);
+				}
+
+				#if defined(__clang__)
+					#pragma clang loop vectorize(assume_safety)
+				#elif defined(__GNUC__)
+					#pragma GCC ivdep
+				#endif
+				for (std::size_t j = 0; j < block; ++j) {
+					target[j] = kernel(source[j]);
+				}
+
+				if (count < block) {
+					std::copy_n(y, count, out + i);
+				}
+			}
+		}
+
+		// Batch e^x.
+		template<typename T>
+		void batch_exp(T const* in, std::size_t n, T* out)
+		{
+			apply(in, n, out, [](T x) { return exp(x); });
+		}
+
+		// Batch natural logarithm.
+		template<typename T>
+		void batch_log(T const* in, std::size_t n, T* out)
+		{
+			apply(in, n, out, [](T x) { return log(x); });
+		}
+
+		// Batch hyperbolic tangent.
+		template<typename T>
+		void batch_tanh(T const* in, std::size_t n, T* out)
+		{
+			apply(in, n, out, [](T x) { return tanh(x); });
+		}
+
+		// Batch sigmoid function.
+		template<typename T>
+		void batch_sigmoid(T const* in, std::size_t n, T* out)
+		{
+			apply(in, n, out, [](T x) { return sigmoid(x); });
+		}
+
+		// Batch derivative of the sigmoid function.
+		template<typename T>
+		void batch_sigmoid_deriv(T const* in, std::size_t n, T* out)
+		{
+			apply(in, n, out, [](T x) { return sigmoid_deriv(x); });
+		}
+
+		// Batch sigmoid function and derivative, from one exponential per element. Blocks are handled as in apply.
+		template<typename T>
+		[[gnu::flatten]] void batch_sigmoid_with_deriv(T const* in, std::size_t n, T* sigmoid_out, T* deriv_out)
+		{
+			constexpr std::size_t block = batch_block<T>;
+
+			T x[block] = {};
+			T s[block];
+			T d[block];
+
+			for (std::size_t i = 0; i < n; i += block) {
+				std::size_t const count = std::min(block, n - i);
+				T const* const source = count == block ? in + i : x;
+				T* const sigmoid_target = count == block ? sigmoid_out + i : s;
+				T* const deriv_target = count == block ? deriv_out + i : d;
+
+				if (count < block) {
+					std::copy_n(in + i, count, x);
+				}
+
+				#if defined(__clang__)
+					#pragma clang loop vectorize(assume_safety)
+				#elif defined(__GNUC__)
+					#pragma GCC ivdep
+				#endif
+				for (std::size_t j = 0; j < block; ++j) {
+					sigmoid_with_deriv(source[j], sigmoid_target[j], deriv_target[j]);
+				}
+
+				if (count < block) {
+					std::copy_n(s, count, sigmoid_out + i);
+					std::copy_n(d, count, deriv_out + i);
+				}
+			}
+		}
+
+
+		/* Batch dispatch */
+
+		/* Whether find_batch substitutes the batch kernels for the elementwise functions of tc::math.
+			Only when compiling for AVX2 or later: with narrower vectors the kernels are about as fast as the standard
+			library for float, and slower for double. */
+		#if defined(__AVX2__)
+			constexpr inline bool replaces_math = true;
+		#else
+			constexpr inline bool replaces_math = false;
+		#endif
+
+		// Pointer to a batch function, out[i] = f(in[i]) for i < n.
+		template<typename T>
+		using batch_function = void (*)(T const* in, std::size_t n, T* out);
+
+		// Detects a `batch(in, n, out)` member of a function object.
+		template<class Function, typename T, typename = void>
+		struct has_batch : std::false_type {};
+
+		// Detects a `batch(in, n, out)` member of a function object.
+		template<class Function, typename T>
+		struct has_batch<Function, T, std::void_t<decltype(std::declval<Function const&>().batch(
+			std::declval<T const*>(), std::size_t{}, std::declval<T*>()))>> : std::true_type {};
+
+		/* Gets the batch function computing the same elementwise function as `function`, or nullptr if there is none.
+			Recognises pointers to the elementwise functions of tc::math_f, and of tc::math if replaces_math.
+			Function objects with a `batch(in, n, out)` member are detected by has_batch instead. */
+		template<typename T, typename Function>
+		batch_function<T> find_batch(Function const& function)
+		{
+			if constexpr (std::is_floating_point_v<T> && std::is_same_v<Function, T (*)(T)>) {
+				if (function == &tc::math_f::sigmoid<T> || (replaces_math && function == &tc::math::sigmoid<T>)) {
+					return &tc::math_f::batch_sigmoid<T>;
+				}
+				if (function == &tc::math_f::sigmoid_deriv<T> || (replaces_math && function == &tc::math::sigmoid_deriv<T>)) {
+					return &tc::math_f::batch_sigmoid_deriv<T>;
+				}
+				if (function == &tc::math_f::exp<T>) {
+					return &tc::math_f::batch_exp<T>;
+				}
+				if (function == &tc::math_f::log<T>) {
+					return &tc::math_f::batch_log<T>;
+				}
+				if (function == &tc::math_f::tanh<T>) {
+					return &tc::math_f::batch_tanh<T>;
+				}
+			}
+			return nullptr;
+		}
+
+		/* Computes out[i] = function(in[i]) for i < n, through the batch kernel matching `function` if there is one
+			(see find_batch and has_batch), otherwise element by element. `in` and `out` may be the same array. */
+		template<typename T, typename Function>
+		void batch_fn(T const* in, std::size_t n, T* out, Function const& function)
+		{
+			if constexpr (has_batch<Function, T>::value) {
+				function.batch(in, n, out);
+			}
+			else if (auto const batch = find_batch<T>(function)) {
+				batch(in, n, out);
+			}
+			else {
+				for (std::size_t i = 0; i < n; ++i) {
+					out[i] = function(in[i]);
+				}
+			}
+		}
+
+	}
+}
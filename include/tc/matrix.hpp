@@ -0,0 +1,287 @@
+#pragma once
+
+#ifdef _DEBUG
+	#include <cassert>			// assert
+#endif
+#include <cstddef>				// std::size_t
+#include <memory>				// std::pointer_traits
+#include <type_traits>			// std::remove_cv_t
+#include <utility>				// std::exchange, std::move
+#include "aligned.hpp"			// tc::aligned::alignment, tc::aligned::allocate, tc::aligned::padded_stride, tc::aligned::unique_array
+#include "matrix_view.hpp"		// tc::matrix_view::matrix_view, tc::matrix_view::row_major
+#include "vector_view.hpp"		// tc::vector_view::vector_view
+
+
+namespace tc {
+	namespace matrix {
+
+		/* Owning matrix, elements stored in an array aligned to tc::aligned::alignment bytes.
+			Elements are stored in the order given by `Layout`, row_major or column_major, and are zeroed on construction.
+			If `Padded`, consecutive rows (row major) or columns (column major) are tc::aligned::padded_stride elements apart,
+			so every line starts on a cache line and power-of-two widths do not alias, otherwise the elements are contiguous.
+			The alignment and padding are part of the type, as the member constants `alignment` and `is_padded`
+			(see tc::aligned::alignment_of and tc::aligned::is_padded).
+			Move-only. Converts implicitly to a matrix_view of its elements, and has the same interface as matrix_view, so it can
+			be passed to the matrix operations directly.
+			Element access is 1-indexed. */
+		template<typename T, typename Layout = tc::matrix_view::row_major, bool Padded = false>
+		class matrix {
+		public:
+
+			/* Member type aliases */
+
+			using element_type = T;
+			using value_type = std::remove_cv_t<element_type>;
+			using size_type = std::size_t;
+			using reference = element_type&;
+			using const_reference = element_type const&;
+			using pointer = element_type*;
+			using const_pointer = element_type const*;
+			using difference_type = typename std::pointer_traits<pointer>::difference_type;
+			using layout = Layout;
+
+			// View of the elements.
+			using view_type = tc::matrix_view::matrix_view<element_type, Layout>;
+
+			// Read-only view of the elements.
+			using const_view_type = tc::matrix_view::matrix_view<element_type const, Layout>;
+
+
+			/* Member constants */
+
+			// Whether elements are stored row major.
+			static constexpr bool is_row_major = view_type::is_row_major;
+
+			// Alignment of the first element in bytes.
+			static constexpr std::size_t alignment = tc::aligned::alignment;
+
+			// Whether every row (row major) or column (column major) starts aligned.
+			static constexpr bool is_padded = Padded;
+
+
+			/* Special members */
+
+			// Destructor.
+			~matrix() = default;
+
+			// Default constructor, an empty matrix.
+			matrix() :
+				_data{},
+				_rows{0},
+				_columns{0},
+				_stride{0}
+			{}
+
+			// Copy constructor - deleted, matrices are move-only.
+			matrix(matrix const&) = delete;
+
+			// Move constructor, `other` is left empty.
+			matrix(matrix&& other) noexcept :
+				_data{std::move(other._data)},
+				_rows{std::exchange(other._rows, 0)},
+				_columns{std::exchange(other._columns, 0)},
+				_stride{std::exchange(other._stride, 0)}
+			{}
+
+			// Constructor from dimensions, elements are zeroed.
+			matrix(size_type rows, size_type columns) :
+				_rows{rows},
+				_columns{columns},
+				_stride{Padded ? tc::aligned::padded_stride<value_type>(is_row_major ? columns : rows) : (is_row_major ? columns : rows)}
+			{
+				_data = tc::aligned::allocate<value_type>((is_row_major ? rows : columns) * _stride);
+			}
+
+
+			/* Operators */
+
+			// Simple assignment - copy - deleted, matrices are move-only.
+			matrix& operator=(matrix const&) = delete;
+
+			// Simple assignment - move, `other` is left empty.
+			matrix& operator=(matrix&& other) noexcept
+			{
+				_data = std::move(other._data);
+				_rows = std::exchange(other._rows, 0);
+				_columns = std::exchange(other._columns, 0);
+				_stride = std::exchange(other._stride, 0);
+				return *this;
+			}
+
+			/* Function call - element access.
+				Bounds checked for debug builds. */
+			reference operator()(size_type row, size_type column)
+			{
+				return view()(row, column);
+			}
+
+			/* Function call - element access.
+				Bounds checked for debug builds. */
+			const_reference operator()(size_type row, size_type column) const
+			{
+				return view()(row, column);
+			}
+
+			// Conversion to a view of the elements.
+			operator view_type()
+			{
+				return view();
+			}
+
+			// Conversion to a read-only view of the elements.
+			operator const_view_type() const
+			{
+				return view();
+			}
+
+
+			/* General member functions */
+
+			/* Gets a view of the specified column.
+				Bounds checked for debug builds. */
+			tc::vector_view::vector_view<element_type> column(size_type column)
+			{
+				return view().column(column);
+			}
+
+			/* Gets a read-only view of the specified column.
+				Bounds checked for debug builds. */
+			tc::vector_view::vector_view<element_type const> column(size_type column) const
+			{
+				return view().column(column);
+			}
+
+			// Gets the number of elements between the starts of consecutive columns.
+			size_type column_stride() const
+			{
+				return is_row_major ? 1 : _stride;
+			}
+
+			// Gets the number of columns.
+			size_type columns() const
+			{
+				return _columns;
+			}
+
+			// Gets the pointer to the start of the array.
+			pointer data()
+			{
+				return _data.get();
+			}
+
+			// Gets the pointer to the start of the array.
+			const_pointer data() const
+			{
+				return _data.get();
+			}
+
+			// Checks whether the elements are contiguous, ie whether there is no padding between rows (or columns).
+			bool is_contiguous() const
+			{
+				return view().is_contiguous();
+			}
+
+			/* Gets a view of the specified row.
+				Bounds checked for debug builds. */
+			tc::vector_view::vector_view<element_type> row(size_type row)
+			{
+				return view().row(row);
+			}
+
+			/* Gets a read-only view of the specified row.
+				Bounds checked for debug builds. */
+			tc::vector_view::vector_view<element_type const> row(size_type row) const
+			{
+				return view().row(row);
+			}
+
+			// Gets the number of elements between the starts of consecutive rows.
+			size_type row_stride() const
+			{
+				return is_row_major ? _stride : 1;
+			}
+
+			// Gets the number of rows.
+			size_type rows() const
+			{
+				return _rows;
+			}
+
+			// Gets the total number of elements.
+			size_type size() const
+			{
+				return _rows * _columns;
+			}
+
+			// Gets the number of elements between the starts of consecutive rows (row major) or columns (column major).
+			size_type stride() const
+			{
+				return _stride;
+			}
+
+			/* Gets a view of the `rows` x `columns` block whose top-left element is (`row`, `column`).
+				Bounds checked for debug builds. */
+			view_type submatrix(size_type row, size_type column, size_type rows, size_type columns)
+			{
+				return view().submatrix(row, column, rows, columns);
+			}
+
+			/* Gets a read-only view of the `rows` x `columns` block whose top-left element is (`row`, `column`).
+				Bounds checked for debug builds. */
+			const_view_type submatrix(size_type row, size_type column, size_type rows, size_type columns) const
+			{
+				return view().submatrix(row, column, rows, columns);
+			}
+
+			// Gets a view of the transpose of this matrix, the same elements in the other storage order.
+			typename view_type::transpose_type transposed()
+			{
+				return view().transposed();
+			}
+
+			// Gets a read-only view of the transpose of this matrix, the same elements in the other storage order.
+			typename const_view_type::transpose_type transposed() const
+			{
+				return view().transposed();
+			}
+
+			// Gets a view of the elements.
+			view_type view()
+			{
+				return {_data.get(), _rows, _columns, _stride};
+			}
+
+			// Gets a read-only view of the elements.
+			const_view_type view() const
+			{
+				return {_data.get(), _rows, _columns, _stride};
+			}
+
+
+		private:
+
+			/* Member variables */
+
+			// Owned, aligned array of elements, including any padding.
+			tc::aligned::unique_array<value_type> _data;
+
+			// Number of rows.
+			size_type _rows;
+
+			// Number of columns.
+			size_type _columns;
+
+			// Number of elements between the starts of consecutive rows (row major) or columns (column major).
+			size_type _stride;
+		};
+
+		// Column major matrix.
+		template<typename T>
+		using matrix_cm = matrix<T, tc::matrix_view::column_major>;
+
+		// Matrix with every row (row major) or column (column major) aligned.
+		template<typename T, typename Layout = tc::matrix_view::row_major>
+		using padded_matrix = matrix<T, Layout, true>;
+
+	}
+}
@@ -4,11 +4,33 @@
 	#include <cassert>		// assert
 #endif
 #include <cstddef>			// std::size_t
+#include "matrix_view.hpp"	// tc::matrix_view::is_column_major_v
 
 
 namespace tc {
 	namespace matrix_ops {
 
+		/* Calls function(i, j) for every element (1-indexed) of `matrix`, in the order the elements are stored.
+			Elementwise operations iterate in the storage order of their result. */
+		template<typename SizeType = std::size_t, class Matrix, typename Function>
+		void for_each_index(Matrix const& matrix, Function function)
+		{
+			if constexpr (tc::matrix_view::is_column_major_v<Matrix>) {
+				for (SizeType j = 1; j <= matrix.columns(); ++j) {
+					for (SizeType i = 1; i <= matrix.rows(); ++i) {
+						function(i, j);
+					}
+				}
+			}
+			else {
+				for (SizeType i = 1; i <= matrix.rows(); ++i) {
+					for (SizeType j = 1; j <= matrix.columns(); ++j) {
+						function(i, j);
+					}
+				}
+			}
+		}
+
 		// Matrix elementwise copy.
 		template<typename SizeType = std::size_t, class InputMatrix, class OutputMatrix>
 		void m_cpy(InputMatrix const& in, OutputMatrix& out)
@@ -18,22 +40,33 @@ namespace tc {
 				assert(in.columns() == out.columns());
 			#endif
 			
-			for (SizeType i = 1; i <= in.rows(); ++i) {
-				for (SizeType j = 1; j <= in.columns(); ++j) {
-					out(i, j) = in(i, j);
-				}
-			}
+			for_each_index<SizeType>(out, [&](SizeType i, SizeType j) {
+				out(i, j) = in(i, j);
+			});
+		}
+
+		/* Evaluates a matrix expression into a matrix, in one pass over the elements.
+			`result` may appear in the expression, each element only reads the same element of its operands. */
+		template<typename SizeType = std::size_t, class Expression, class OutputMatrix>
+		void m_eval(Expression const& expression, OutputMatrix& result)
+		{
+			#ifdef _DEBUG
+				assert(expression.rows() == result.rows());
+				assert(expression.columns() == result.columns());
+			#endif
+
+			for_each_index<SizeType>(result, [&](SizeType i, SizeType j) {
+				result(i, j) = expression(i, j);
+			});
 		}
 
 		// Sets all matrix elements to a value.
 		template<typename SizeType = std::size_t, class OutputMatrix, typename Element>
 		void m_fill(OutputMatrix& matrix, Element const& val)
 		{
-			for (SizeType i = 1; i <= matrix.rows(); ++i) {
-				for (SizeType j = 1; j <= matrix.columns(); ++j) {
-					matrix(i ,j) = val;
-				}
-			}
+			for_each_index<SizeType>(matrix, [&](SizeType i, SizeType j) {
+				matrix(i, j) = val;
+			});
 		}
 
 		// Transforms each matrix element with a function.
@@ -45,11 +78,9 @@ namespace tc {
 				assert(in.columns() == result.columns());
 			#endif
 			
-			for (SizeType i = 1; i <= in.rows(); ++i) {
-				for (SizeType j = 1; j <= in.columns(); ++j) {
-					result(i, j) = function(in(i, j));
-				}
-			}
+			for_each_index<SizeType>(result, [&](SizeType i, SizeType j) {
+				result(i, j) = function(in(i, j));
+			});
 		}
 
 		/* Matrix transposition.
@@ -58,15 +89,13 @@ namespace tc {
 		void m_trn(InputMatrix const& in, OutputMatrix& result)
 		{
 			#ifdef _DEBUG
-				assert(in.rows() == result.rows());
-				assert(in.columns() == result.columns());
+				assert(in.rows() == result.columns());
+				assert(in.columns() == result.rows());
 			#endif
 			
-			for (SizeType i = 1; i <= in.rows(); ++i) {
-				for (SizeType j = 1; j <= in.columns(); ++j) {
-					result(j, i) = in(i, j);
-				}
-			}
+			for_each_index<SizeType>(result, [&](SizeType j, SizeType i) {
+				result(j, i) = in(i, j);
+			});
 		}
 
 		// Matrix-matrix elementwise addition.
@@ -80,11 +109,9 @@ namespace tc {
 				assert(lhs.columns() == result.columns());
 			#endif
 			
-			for (SizeType i = 1; i <= lhs.rows(); ++i) {
-				for (SizeType j = 1; j <= lhs.columns(); ++j) {
-					result(i, j) = lhs(i, j) + rhs(i, j);
-				}
-			}
+			for_each_index<SizeType>(result, [&](SizeType i, SizeType j) {
+				result(i, j) = lhs(i, j) + rhs(i, j);
+			});
 		}
 
 		// Matrix-matrix Hadamard (elementwise) product.
@@ -98,14 +125,15 @@ namespace tc {
 				assert(lhs.columns() == result.columns());
 			#endif
 			
-			for (SizeType i = 1; i <= lhs.rows(); ++i) {
-				for (SizeType j = 1; j <= lhs.columns(); ++j) {
-					result(i, j) = lhs(i, j) * rhs(i, j);
-				}
-			}
+			for_each_index<SizeType>(result, [&](SizeType i, SizeType j) {
+				result(i, j) = lhs(i, j) * rhs(i, j);
+			});
 		}
 
-		// Matrix-matrix multiplication.
+		/* Matrix-matrix multiplication.
+			The loop order is chosen from the storage orders of the operands so the innermost loop walks adjacent elements:
+			j-k-i when `result` and `lhs` are column major, i-k-j when `result` and `rhs` are row major, otherwise i-j-k.
+			Each element is summed over k in ascending order whichever loop order is used. */
 		template<typename SizeType = std::size_t, class InputMatrix1, class InputMatrix2, class OutputMatrix>
 		void mm_mul(InputMatrix1 const& lhs, InputMatrix2 const& rhs, OutputMatrix& result)
 		{
@@ -115,11 +143,95 @@ namespace tc {
 				assert(rhs.columns() == result.columns());
 			#endif
 			
-			for (SizeType i = 1; i <= lhs.rows(); ++i) {
+			using tc::matrix_view::is_column_major_v;
+
+			if constexpr (is_column_major_v<OutputMatrix> && is_column_major_v<InputMatrix1>) {
+				for (SizeType j = 1; j <= rhs.columns(); ++j) {
+					for (SizeType i = 1; i <= lhs.rows(); ++i) {
+						result(i, j) = typename OutputMatrix::value_type{};
+					}
+					for (SizeType k = 1; k <= lhs.columns(); ++k) {
+						auto const b = rhs(k, j);
+						for (SizeType i = 1; i <= lhs.rows(); ++i) {
+							result(i, j) += lhs(i, k) * b;
+						}
+					}
+				}
+			}
+			else if constexpr (!is_column_major_v<OutputMatrix> && !is_column_major_v<InputMatrix2>) {
+				for (SizeType i = 1; i <= lhs.rows(); ++i) {
+					for (SizeType j = 1; j <= rhs.columns(); ++j) {
+						result(i, j) = typename OutputMatrix::value_type{};
+					}
+					for (SizeType k = 1; k <= lhs.columns(); ++k) {
+						auto const a = lhs(i, k);
+						for (SizeType j = 1; j <= rhs.columns(); ++j) {
+							result(i, j) += a * rhs(k, j);
+						}
+					}
+				}
+			}
+			else {
+				for (SizeType i = 1; i <= lhs.rows(); ++i) {
+					for (SizeType j = 1; j <= rhs.columns(); ++j) {
+						result(i, j) = typename OutputMatrix::value_type{};
+						for (SizeType k = 1; k <= lhs.columns(); ++k) {
+							result(i, j) += lhs(i, k) * rhs(k, j);
+						}
+					}
+				}
+			}
+		}
+
+		/* Matrix-matrix multiplication, result = alpha lhs rhs + beta result.
+			Loop orders as mm_mul. `result` is first scaled by `beta` (set to zero, without being read, when `beta` is zero),
+			then the product is accumulated into it, `alpha` folded into the operand element hoisted out of the inner loop. */
+		template<typename SizeType = std::size_t, typename Element1, class InputMatrix1, class InputMatrix2, typename Element2, class OutputMatrix>
+		void mm_mul(Element1 const& alpha, InputMatrix1 const& lhs, InputMatrix2 const& rhs, Element2 const& beta, OutputMatrix& result)
+		{
+			#ifdef _DEBUG
+				assert(lhs.columns() == rhs.rows());
+				assert(lhs.rows() == result.rows());
+				assert(rhs.columns() == result.columns());
+			#endif
+
+			using tc::matrix_view::is_column_major_v;
+			using value_type = typename OutputMatrix::value_type;
+
+			if constexpr (is_column_major_v<OutputMatrix> && is_column_major_v<InputMatrix1>) {
 				for (SizeType j = 1; j <= rhs.columns(); ++j) {
-					result(i, j) = OutputMatrix::value_type{};
+					for (SizeType i = 1; i <= lhs.rows(); ++i) {
+						result(i, j) = beta == Element2{} ? value_type{} : beta * result(i, j);
+					}
 					for (SizeType k = 1; k <= lhs.columns(); ++k) {
-						result(i, j) += lhs(i, k) * rhs(k, j)
+						auto const b = alpha * rhs(k, j);
+						for (SizeType i = 1; i <= lhs.rows(); ++i) {
+							result(i, j) += lhs(i, k) * b;
+						}
+					}
+				}
+			}
+			else if constexpr (!is_column_major_v<OutputMatrix> && !is_column_major_v<InputMatrix2>) {
+				for (SizeType i = 1; i <= lhs.rows(); ++i) {
+					for (SizeType j = 1; j <= rhs.columns(); ++j) {
+						result(i, j) = beta == Element2{} ? value_type{} : beta * result(i, j);
+					}
+					for (SizeType k = 1; k <= lhs.columns(); ++k) {
+						auto const a = alpha * lhs(i, k);
+						for (SizeType j = 1; j <= rhs.columns(); ++j) {
+							result(i, j) += a * rhs(k, j);
+						}
+					}
+				}
+			}
+			else {
+				for (SizeType i = 1; i <= lhs.rows(); ++i) {
+					for (SizeType j = 1; j <= rhs.columns(); ++j) {
+						value_type sum{};
+						for (SizeType k = 1; k <= lhs.columns(); ++k) {
+							sum += lhs(i, k) * rhs(k, j);
+						}
+						result(i, j) = beta == Element2{} ? alpha * sum : alpha * sum + beta * result(i, j);
 					}
 				}
 			}
@@ -136,11 +248,9 @@ namespace tc {
 				assert(lhs.columns() == result.columns());
 			#endif
 			
-			for (SizeType i = 1; i <= lhs.rows(); ++i) {
-				for (SizeType j = 1; j <= lhs.columns(); ++j) {
-					result(i, j) = lhs(i, j) - rhs(i, j);
-				}
-			}
+			for_each_index<SizeType>(result, [&](SizeType i, SizeType j) {
+				result(i, j) = lhs(i, j) - rhs(i, j);
+			});
 		}
 
 		// Matrix-scalar elementwise multiplication.
@@ -152,11 +262,9 @@ namespace tc {
 				assert(lhs.columns() == result.columns());
 			#endif
 			
-			for (SizeType i = 1; i <= lhs.rows(); ++i) {
-				for (SizeType j = 1; j <= lhs.columns(); ++j) {
-					result(i, j) = lhs(i, j) * rhs;
-				}
-			}
+			for_each_index<SizeType>(result, [&](SizeType i, SizeType j) {
+				result(i, j) = lhs(i, j) * rhs;
+			});
 		}
 
 		// Scalar-matrix elementwise multiplication.
@@ -168,11 +276,9 @@ namespace tc {
 				assert(rhs.columns() == result.columns());
 			#endif
 			
-			for (SizeType i = 1; i <= rhs.rows(); ++i) {
-				for (SizeType j = 1; j <= rhs.columns(); ++j) {
-					result(i, j) = lhs * rhs(i, j);
-				}
-			}
+			for_each_index<SizeType>(result, [&](SizeType i, SizeType j) {
+				result(i, j) = lhs * rhs(i, j);
+			});
 		}
 		
 	}
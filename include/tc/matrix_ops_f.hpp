@@ -1,17 +1,100 @@
 #pragma once
 
-#include <algorithm>		// std::transform, std::copy, std::fill
+#include <algorithm>		// std::max
 #ifdef _DEBUG
 	#include <cassert>		// assert
 #endif
-#include <cstddef>			// std::size_t
-#include <execution>		// std::execution::par_unseq
+#include <cstddef>			// std::size_t, std::ptrdiff_t
 #include <functional>		// std::plus, std::multiplies, std::minus
+#include <type_traits>		// std::decay_t, std::is_same_v
+#include <utility>			// std::pair
+#include "aligned.hpp"		// tc::aligned::alignment_of_v, tc::aligned::assume_aligned
+#include "array_view.hpp"	// tc::array_view::array_view3d
+#include "gemm.hpp"			// tc::gemm::gemm, tc::gemm::parallel_gemm, tc::gemm::small_gemm, tc::gemm::small_limit
+#include "math_f.hpp"		// tc::math_f::find_batch, tc::math_f::has_batch
+#include "matrix_ops.hpp"	// tc::matrix_ops::mm_mul
+#include "matrix_view.hpp"	// tc::matrix_view::is_column_major_v
+#include "parallel.hpp"		// tc::parallel::for_each_chunk, tc::parallel::chunk_size
+#include "transpose.hpp"		// tc::transpose::copy, tc::transpose::transpose_square
 
 namespace tc {
 	namespace matrix_ops_f {
-		
-		// Matrix elementwise copy.
+
+		/* Sets result(i, j) = function(in(i, j)...) for every element, elements split across threads.
+			Operands that are all contiguous and share a storage order are treated as flat arrays, whose alignment is known at
+			compile time for tc::matrix::matrix operands. Otherwise `result` is walked line by line in its own storage order
+			and each input is addressed through its row and column strides. */
+		template<class OutputMatrix, typename Function, class... InputMatrices>
+		void m_map(OutputMatrix& result, Function function, InputMatrices const&... in)
+		{
+			using tc::matrix_view::is_column_major_v;
+
+			constexpr bool same_layout = ((is_column_major_v<InputMatrices> == is_column_major_v<OutputMatrix>) && ...);
+
+			if (same_layout && result.is_contiguous() && (in.is_contiguous() && ...)) {
+				using tc::aligned::alignment_of_v;
+				using tc::aligned::assume_aligned;
+
+				tc::parallel::for_each_chunk(result.size(), [&](std::size_t begin, std::size_t end) {
+					auto const out = assume_aligned<alignment_of_v<OutputMatrix>>(result.data());
+
+					for (std::size_t k = begin; k < end; ++k) {
+						out[k] = function(assume_aligned<alignment_of_v<InputMatrices>>(in.data())[k]...);
+					}
+				});
+				return;
+			}
+
+			constexpr bool column_major = is_column_major_v<OutputMatrix>;
+
+			std::size_t const lines = column_major ? result.columns() : result.rows();
+			std::size_t const length = column_major ? result.rows() : result.columns();
+			std::size_t const lines_per_chunk = std::max<std::size_t>(tc::parallel::chunk_size / std::max<std::size_t>(length, 1), 1);
+
+			// Pointer to element (i, j) (0-indexed) of a matrix.
+			auto const at = [](auto& matrix, std::size_t i, std::size_t j) {
+				return matrix.data() + i * matrix.row_stride() + j * matrix.column_stride();
+			};
+
+			tc::parallel::for_each_chunk(lines, [&](std::size_t begin, std::size_t end) {
+				for (std::size_t l = begin; l < end; ++l) {
+					for (std::size_t e = 0; e < length; ++e) {
+						std::size_t const i = column_major ? e : l;
+						std::size_t const j = column_major ? l : e;
+
+						*at(result, i, j) = function(*at(in, i, j)...);
+					}
+				}
+			}, lines_per_chunk);
+		}
+
+		/* Calls batch(in, n, out) over the elements of `in` and `result`, which share a storage order, split across threads.
+			Contiguous matrices are treated as flat arrays, otherwise each call covers part of a row (row major) or column (column major). */
+		template<class InputMatrix, class OutputMatrix, typename Batch>
+		void m_batch(InputMatrix const& in, OutputMatrix& result, Batch batch)
+		{
+			if (in.is_contiguous() && result.is_contiguous()) {
+				tc::parallel::for_each_chunk(result.size(), [&](std::size_t begin, std::size_t end) {
+					batch(in.data() + begin, end - begin, result.data() + begin);
+				});
+				return;
+			}
+
+			constexpr bool column_major = tc::matrix_view::is_column_major_v<OutputMatrix>;
+
+			std::size_t const lines = column_major ? result.columns() : result.rows();
+			std::size_t const length = column_major ? result.rows() : result.columns();
+			std::size_t const lines_per_chunk = std::max<std::size_t>(tc::parallel::chunk_size / std::max<std::size_t>(length, 1), 1);
+
+			tc::parallel::for_each_chunk(lines, [&](std::size_t begin, std::size_t end) {
+				for (std::size_t l = begin; l < end; ++l) {
+					batch(in.data() + l * in.stride(), length, result.data() + l * result.stride());
+				}
+			}, lines_per_chunk);
+		}
+
+		/* Matrix elementwise copy.
+			Matrices with differing storage orders are copied with the blocked transpose. */
 		template<typename SizeType = std::size_t, class InputMatrix, class OutputMatrix>
 		void m_cpy(InputMatrix const& in, OutputMatrix& out)
 		{
@@ -20,17 +103,54 @@ namespace tc {
 				assert(in.columns() == out.columns());
 			#endif
 			
-			std::copy(std::execution::par_unseq, in.data(), in.data() + in.size(), out.data());
+			tc::transpose::copy<typename OutputMatrix::value_type>(in.rows(), in.columns(),
+				in.data(), static_cast<std::ptrdiff_t>(in.row_stride()), static_cast<std::ptrdiff_t>(in.column_stride()),
+				out.data(), static_cast<std::ptrdiff_t>(out.row_stride()), static_cast<std::ptrdiff_t>(out.column_stride()));
 		}
 		
+		/* Evaluates a matrix expression into a matrix, in one pass over the elements.
+			Blocks of lines, in the storage order of `result`, are split across threads.
+			`result` may appear in the expression, each element only reads the same element of its operands. */
+		template<typename SizeType = std::size_t, class Expression, class OutputMatrix>
+		void m_eval(Expression const& expression, OutputMatrix& result)
+		{
+			#ifdef _DEBUG
+				assert(expression.rows() == result.rows());
+				assert(expression.columns() == result.columns());
+			#endif
+
+			constexpr bool column_major = tc::matrix_view::is_column_major_v<OutputMatrix>;
+
+			std::size_t const lines = column_major ? result.columns() : result.rows();
+			std::size_t const length = column_major ? result.rows() : result.columns();
+			std::size_t const lines_per_chunk = std::max<std::size_t>(tc::parallel::chunk_size / std::max<std::size_t>(length, 1), 1);
+
+			tc::parallel::for_each_chunk(lines, [&](std::size_t begin, std::size_t end) {
+				for (SizeType l = begin + 1; l <= end; ++l) {
+					for (SizeType e = 1; e <= length; ++e) {
+						if constexpr (column_major) {
+							result(e, l) = expression(e, l);
+						}
+						else {
+							result(l, e) = expression(l, e);
+						}
+					}
+				}
+			}, lines_per_chunk);
+		}
+
 		// Sets all matrix elements to a value.
 		template<typename SizeType = std::size_t, class OutputMatrix, typename Element>
 		void m_fill(OutputMatrix& matrix, Element const& val)
 		{
-			std::fill(std::execution::par_unseq, matrix.data(), matrix.data() + matrix.size(), val);
+			m_map(matrix, [&]() { return val; });
 		}
 
-		// Transforms each matrix element with a function.
+		/* Transforms each matrix element with a function.
+			The vectorised batch kernels of tc::math_f are used when `function` is one of the elementwise functions of
+			tc::math_f (or of tc::math when compiling for AVX2, see tc::math_f::replaces_math), or has a `batch(in, n, out)`
+			member, and `in` and `result` share a value type and storage order.
+			Batch results match the elementwise ones to within the error bounds documented in tc::math_f. */
 		template<typename SizeType = std::size_t, class InputMatrix, class OutputMatrix, typename Function>
 		void m_fn(InputMatrix const& in, OutputMatrix& result, Function function)
 		{
@@ -39,7 +159,55 @@ namespace tc {
 				assert(in.columns() == result.columns());
 			#endif
 			
-			std::transform(std::execution::par_unseq, in.data(), in.data() + in.size(), result.data(), function);
+			using value_type = typename OutputMatrix::value_type;
+			using tc::matrix_view::is_column_major_v;
+
+			constexpr bool batchable = std::is_same_v<typename InputMatrix::value_type, value_type>
+				&& is_column_major_v<InputMatrix> == is_column_major_v<OutputMatrix>;
+
+			if constexpr (batchable && tc::math_f::has_batch<Function, value_type>::value) {
+				m_batch(in, result, [&](value_type const* src, std::size_t n, value_type* dst) { function.batch(src, n, dst); });
+				return;
+			}
+			else if constexpr (batchable) {
+				if (auto const batch = tc::math_f::find_batch<value_type>(function)) {
+					m_batch(in, result, batch);
+					return;
+				}
+			}
+
+			m_map(result, function, in);
+		}
+
+		/* Matrix transposition.
+			Blocked and multi-threaded, with micro tiles transposed in registers. `in` may have any shape.
+			If `in` and `result` have different storage orders the elements are already in place and are copied line by line,
+			a transposed() view avoids even that copy.
+			`in` must not refer to the same data as `result`, use m_trn_inplace for that. */
+		template<typename SizeType = std::size_t, class InputMatrix, class OutputMatrix>
+		void m_trn(InputMatrix const& in, OutputMatrix& result)
+		{
+			#ifdef _DEBUG
+				assert(in.rows() == result.columns());
+				assert(in.columns() == result.rows());
+			#endif
+
+			tc::transpose::copy<typename OutputMatrix::value_type>(in.rows(), in.columns(),
+				in.data(), static_cast<std::ptrdiff_t>(in.row_stride()), static_cast<std::ptrdiff_t>(in.column_stride()),
+				result.data(), static_cast<std::ptrdiff_t>(result.column_stride()), static_cast<std::ptrdiff_t>(result.row_stride()));
+		}
+
+		/* In-place matrix transposition (square matrices only).
+			Transposing the stored array transposes the matrix in either storage order. */
+		template<typename SizeType = std::size_t, class Matrix>
+		void m_trn_inplace(Matrix& matrix)
+		{
+			#ifdef _DEBUG
+				assert(matrix.rows() == matrix.columns());
+			#endif
+
+			tc::transpose::transpose_square<typename Matrix::value_type>(matrix.rows(),
+				matrix.data(), static_cast<std::ptrdiff_t>(matrix.stride()));
 		}
 		
 		// Matrix-matrix elementwise addition.
@@ -53,7 +221,7 @@ namespace tc {
 				assert(lhs.columns() == result.columns());
 			#endif
 			
-			std::transform(std::execution::par_unseq, lhs.data(), lhs.data() + lhs.size(), rhs.data(), result.data(), std::plus());
+			m_map(result, std::plus(), lhs, rhs);
 		}
 
 		// Matrix-matrix elementwise subtraction.
@@ -67,7 +235,7 @@ namespace tc {
 				assert(lhs.columns() == result.columns());
 			#endif
 			
-			std::transform(std::execution::par_unseq, lhs.data(), lhs.data() + lhs.size(), rhs.data(), result.data(), std::minus());
+			m_map(result, std::minus(), lhs, rhs);
 		}
 
 		// Matrix-matrix Hadamard (elementwise) product.
@@ -81,7 +249,184 @@ namespace tc {
 				assert(lhs.columns() == result.columns());
 			#endif
 			
-			std::transform(std::execution::par_unseq, lhs.data(), lhs.data() + lhs.size(), rhs.data(), result.data(), std::multiplies());
+			m_map(result, std::multiplies(), lhs, rhs);
+		}
+
+		/* Matrix-matrix multiplication.
+			Uses the multi-threaded, cache-blocked tc::gemm kernel when all three matrices share a value type,
+			otherwise falls back to tc::matrix_ops::mm_mul. The kernel packs its operands, so any mix of storage orders runs at full speed.
+			Sums are accumulated in a different order to tc::matrix_ops::mm_mul, so for floating point types the results
+			differ by rounding only: elementwise, |result - exact| <= k * u * (|lhs| |rhs|) to first order, where k is
+			lhs.columns() and u is the unit roundoff. Results are bitwise identical for any number of threads.
+			`result` must not refer to the same data as `lhs` or `rhs`. */
+		template<typename SizeType = std::size_t, class InputMatrix1, class InputMatrix2, class OutputMatrix>
+		void mm_mul(InputMatrix1 const& lhs, InputMatrix2 const& rhs, OutputMatrix& result)
+		{
+			#ifdef _DEBUG
+				assert(lhs.columns() == rhs.rows());
+				assert(lhs.rows() == result.rows());
+				assert(rhs.columns() == result.columns());
+			#endif
+
+			using value_type = typename OutputMatrix::value_type;
+
+			if constexpr (std::is_same_v<typename InputMatrix1::value_type, value_type> && std::is_same_v<typename InputMatrix2::value_type, value_type>) {
+				auto const strides = [](auto const& matrix) {
+					return std::pair{static_cast<std::ptrdiff_t>(matrix.row_stride()), static_cast<std::ptrdiff_t>(matrix.column_stride())};
+				};
+				auto const [rsa, csa] = strides(lhs);
+				auto const [rsb, csb] = strides(rhs);
+				auto const [rsc, csc] = strides(result);
+
+				tc::gemm::parallel_gemm<value_type>(lhs.rows(), rhs.columns(), lhs.columns(),
+					lhs.data(), rsa, csa, rhs.data(), rsb, csb, result.data(), rsc, csc);
+			}
+			else {
+				tc::matrix_ops::mm_mul<SizeType>(lhs, rhs, result);
+			}
+		}
+
+		/* Matrix-matrix multiplication, result = alpha lhs rhs + beta result.
+			As mm_mul, but `alpha` and `beta` are applied as each register tile of `result` is written by the tc::gemm kernel,
+			so accumulating a product into `result` (beta one) takes no temporary matrix and no extra pass.
+			`result` is not read when `beta` is zero, so it need not be initialised.
+			Falls back to tc::matrix_ops::mm_mul if the matrices do not share a value type.
+			`result` must not refer to the same data as `lhs` or `rhs`. */
+		template<typename SizeType = std::size_t, typename Element1, class InputMatrix1, class InputMatrix2, typename Element2, class OutputMatrix>
+		void mm_mul(Element1 const& alpha, InputMatrix1 const& lhs, InputMatrix2 const& rhs, Element2 const& beta, OutputMatrix& result)
+		{
+			#ifdef _DEBUG
+				assert(lhs.columns() == rhs.rows());
+				assert(lhs.rows() == result.rows());
+				assert(rhs.columns() == result.columns());
+			#endif
+
+			using value_type = typename OutputMatrix::value_type;
+
+			if constexpr (std::is_same_v<typename InputMatrix1::value_type, value_type> && std::is_same_v<typename InputMatrix2::value_type, value_type>) {
+				auto const strides = [](auto const& matrix) {
+					return std::pair{static_cast<std::ptrdiff_t>(matrix.row_stride()), static_cast<std::ptrdiff_t>(matrix.column_stride())};
+				};
+				auto const [rsa, csa] = strides(lhs);
+				auto const [rsb, csb] = strides(rhs);
+				auto const [rsc, csc] = strides(result);
+
+				tc::gemm::parallel_gemm<value_type>(lhs.rows(), rhs.columns(), lhs.columns(), static_cast<value_type>(alpha),
+					lhs.data(), rsa, csa, rhs.data(), rsb, csb, static_cast<value_type>(beta), result.data(), rsc, csc);
+			}
+			else {
+				tc::matrix_ops::mm_mul<SizeType>(alpha, lhs, rhs, beta, result);
+			}
+		}
+
+		/* Batched matrix-matrix multiplication, result[b] = lhs[b] rhs[b] for every b in [0, lhs.size()).
+			`lhs`, `rhs` and `result` are sequences of matrices (anything with size() and operator[], eg a std::vector of
+			matrix_views), the products are independent and may differ in shape.
+			The batch is split across threads, each product is computed on one thread: products up to tc::gemm::small_limit
+			by the unpacked tc::gemm::small_gemm kernel, bigger ones by the serial packed tc::gemm kernel.
+			Results do not depend on the number of threads.
+			Falls back to tc::matrix_ops::mm_mul for each product if the matrices do not share a value type.
+			No result may refer to the same data as any operand. */
+		template<typename SizeType = std::size_t, class InputMatrices1, class InputMatrices2, class OutputMatrices>
+		void mm_mul_batched(InputMatrices1 const& lhs, InputMatrices2 const& rhs, OutputMatrices& result)
+		{
+			#ifdef _DEBUG
+				assert(lhs.size() == rhs.size());
+				assert(lhs.size() == result.size());
+			#endif
+
+			if (lhs.size() == 0) {
+				return;
+			}
+
+			using input_type1 = std::decay_t<decltype(lhs[0])>;
+			using input_type2 = std::decay_t<decltype(rhs[0])>;
+			using output_type = std::decay_t<decltype(result[0])>;
+			using value_type = typename output_type::value_type;
+
+			// Multiplies one pair of operands.
+			auto const multiply = [](input_type1 const& a, input_type2 const& b, output_type c) {
+				#ifdef _DEBUG
+					assert(a.columns() == b.rows());
+					assert(a.rows() == c.rows());
+					assert(b.columns() == c.columns());
+				#endif
+
+				if constexpr (std::is_same_v<typename input_type1::value_type, value_type> && std::is_same_v<typename input_type2::value_type, value_type>) {
+					std::size_t const m = a.rows();
+					std::size_t const n = b.columns();
+					std::size_t const k = a.columns();
+					auto const rs = [](auto const& matrix) { return static_cast<std::ptrdiff_t>(matrix.row_stride()); };
+					auto const cs = [](auto const& matrix) { return static_cast<std::ptrdiff_t>(matrix.column_stride()); };
+
+					if (m * n * k <= tc::gemm::small_limit) {
+						tc::gemm::small_gemm<value_type>(m, n, k, a.data(), rs(a), cs(a), b.data(), rs(b), cs(b), c.data(), rs(c), cs(c));
+					}
+					else {
+						tc::gemm::gemm<value_type>(m, n, k, a.data(), rs(a), cs(a), b.data(), rs(b), cs(b), c.data(), rs(c), cs(c));
+					}
+				}
+				else {
+					tc::matrix_ops::mm_mul<SizeType>(a, b, c);
+				}
+			};
+
+			// Enough products per task to amortise scheduling, judged by the size of the first.
+			std::size_t const work = std::max<std::size_t>(lhs[0].rows() * rhs[0].columns() * lhs[0].columns(), 1);
+			std::size_t const products_per_chunk = std::max<std::size_t>(tc::parallel::chunk_size / work, 1);
+
+			tc::parallel::for_each_chunk(lhs.size(), [&](std::size_t begin, std::size_t end) {
+				for (std::size_t i = begin; i < end; ++i) {
+					multiply(lhs[i], rhs[i], result[i]);
+				}
+			}, products_per_chunk);
+		}
+
+		/* Batched matrix-matrix multiplication of stacked matrices, result[b] = lhs[b] rhs[b].
+			Dimension 0 of each array is the batch, dimensions 1 and 2 the rows and columns of a row major matrix,
+			so `lhs` is batch x m x k, `rhs` batch x k x n and `result` batch x m x n. Computed as mm_mul_batched of matrix_views
+			of the slices, so the arrays may be strided (eg a subview) as long as elements of a row are adjacent, checked for
+			debug builds. */
+		template<typename SizeType = std::size_t, typename T1, typename T2, typename T3>
+		void mm_mul_batched(tc::array_view::array_view3d<T1> const& lhs, tc::array_view::array_view3d<T2> const& rhs, tc::array_view::array_view3d<T3>& result)
+		{
+			#ifdef _DEBUG
+				assert(lhs.dim_size(0) == rhs.dim_size(0));
+				assert(lhs.dim_size(0) == result.dim_size(0));
+				assert(lhs.stride(2) == 1 && rhs.stride(2) == 1 && result.stride(2) == 1);
+			#endif
+
+			// Sequence of views of the matrices of a stack, made on access so that nothing is allocated.
+			auto const slices = [](auto const& array) {
+				using element_type = typename std::decay_t<decltype(array)>::element_type;
+
+				struct sequence {
+					element_type* data;
+					std::size_t batch;
+					std::size_t rows;
+					std::size_t columns;
+					std::size_t batch_stride;
+					std::size_t row_stride;
+
+					std::size_t size() const
+					{
+						return batch;
+					}
+
+					tc::matrix_view::matrix_view<element_type> operator[](std::size_t b) const
+					{
+						return {data + b * batch_stride, rows, columns, row_stride};
+					}
+				};
+
+				return sequence{array.data(), array.dim_size(0), array.dim_size(1), array.dim_size(2), array.stride(0), array.stride(1)};
+			};
+
+			auto const lhs_views = slices(lhs);
+			auto const rhs_views = slices(rhs);
+			auto result_views = slices(result);
+
+			mm_mul_batched<SizeType>(lhs_views, rhs_views, result_views);
 		}
 
 		// Matrix-scalar elementwise multiplication.
@@ -93,7 +438,9 @@ namespace tc {
 				assert(lhs.columns() == result.columns());
 			#endif
 			
-			std::transform(std::execution::par_unseq, lhs.data(), lhs.data() + lhs.size(), result.data(), [=](InputMatrix::value_type x){ return rhs * x; });
+			auto const scale = [=](typename InputMatrix::value_type x){ return rhs * x; };
+
+			m_map(result, scale, lhs);
 		}
 
 		// Scalar-matrix elementwise multiplication.
@@ -105,7 +452,76 @@ namespace tc {
 				assert(rhs.columns() == result.columns());
 			#endif
 			
-			std::transform(std::execution::par_unseq, rhs.data(), rhs.data() + rhs.size(), result.data(), [=](InputMatrix::value_type x){ return lhs * x; });
+			auto const scale = [=](typename InputMatrix::value_type x){ return lhs * x; };
+
+			m_map(result, scale, rhs);
+		}
+
+		/* Batched dense layer forward pass, result = activation(weights input + bias 1^T), with `activation` applied elementwise.
+			Each column of `input` is one sample, `bias` is added to every column of the product. Pass transposed() views
+			to work with samples as rows.
+			The product is computed by the tc::gemm kernel, which biases and activates each tile of `result` as soon as the
+			tile is complete, while it is still in cache. `activation` goes through the batch kernels of tc::math_f when it is
+			one of their functions (see tc::math_f::batch_fn).
+			Falls back to tc::matrix_ops::mm_mul and an elementwise pass if the matrices do not share a value type.
+			`result` must not refer to the same data as `weights` or `input`. */
+		template<typename SizeType = std::size_t, class InputMatrix1, class InputMatrix2, class InputVector, typename Function, class OutputMatrix>
+		void dense_forward(InputMatrix1 const& weights, InputMatrix2 const& input, InputVector const& bias, Function activation, OutputMatrix& result)
+		{
+			#ifdef _DEBUG
+				assert(weights.columns() == input.rows());
+				assert(weights.rows() == result.rows());
+				assert(input.columns() == result.columns());
+				assert(bias.size() == result.rows());
+			#endif
+
+			using value_type = typename OutputMatrix::value_type;
+
+			if constexpr (std::is_same_v<typename InputMatrix1::value_type, value_type> && std::is_same_v<typename InputMatrix2::value_type, value_type>) {
+				auto const c = result.data();
+				std::size_t const stride = result.stride();
+
+				// Biases and activates the tile of `result` with top-left element (i, j) (0-indexed), line by line in storage order.
+				auto const epilogue = [&](std::size_t i, std::size_t j, std::size_t rows, std::size_t columns) {
+					if constexpr (tc::matrix_view::is_column_major_v<OutputMatrix>) {
+						for (std::size_t l = j; l < j + columns; ++l) {
+							value_type* const line = c + l * stride + i;
+
+							for (std::size_t e = 0; e < rows; ++e) {
+								line[e] += bias(i + e + 1);
+							}
+							tc::math_f::batch_fn(line, rows, line, activation);
+						}
+					}
+					else {
+						for (std::size_t l = i; l < i + rows; ++l) {
+							value_type* const line = c + l * stride + j;
+							value_type const b = bias(l + 1);
+
+							for (std::size_t e = 0; e < columns; ++e) {
+								line[e] += b;
+							}
+							tc::math_f::batch_fn(line, columns, line, activation);
+						}
+					}
+				};
+
+				auto const strides = [](auto const& matrix) {
+					return std::pair{static_cast<std::ptrdiff_t>(matrix.row_stride()), static_cast<std::ptrdiff_t>(matrix.column_stride())};
+				};
+				auto const [rsa, csa] = strides(weights);
+				auto const [rsb, csb] = strides(input);
+				auto const [rsc, csc] = strides(result);
+
+				tc::gemm::parallel_gemm<value_type>(weights.rows(), input.columns(), weights.columns(),
+					weights.data(), rsa, csa, input.data(), rsb, csb, c, rsc, csc, epilogue);
+			}
+			else {
+				tc::matrix_ops::mm_mul<SizeType>(weights, input, result);
+				tc::matrix_ops::for_each_index<SizeType>(result, [&](SizeType i, SizeType j) {
+					result(i, j) = activation(result(i, j) + bias(i));
+				});
+			}
 		}
 
 	}
@@ -6,16 +6,26 @@
 #include <cstddef>				// std::size_t
 #include <memory>				// std::pointer_traits
 #include <stdexcept>			// std::out_of_range
-#include <type_traits>			// std::remove_cv_t
+#include <type_traits>			// std::remove_cv_t, std::conditional_t, std::is_same, std::is_same_v, std::false_type, std::void_t
+#include "vector_view.hpp"		// tc::vector_view::vector_view
 
 
 namespace tc {
 	namespace matrix_view {
 
-		/* Non-owning view of a contiguous array for use as a mathematical matrix.
-			Elements are viewed as row major.
+		// Storage order tag - elements of a row are adjacent.
+		struct row_major {};
+
+		// Storage order tag - elements of a column are adjacent.
+		struct column_major {};
+
+		/* Non-owning view of an array for use as a mathematical matrix.
+			Elements are viewed in the storage order given by `Layout`, row_major or column_major.
+			Consecutive rows (row major) or columns (column major) are `stride` elements apart.
+			The stride defaults to the number of columns (row major) or rows (column major), ie a contiguous matrix,
+			larger strides view a block of a bigger matrix.
 			Element access is 1-indexed. */
-		template<typename T>
+		template<typename T, typename Layout = row_major>
 		class matrix_view {
 		public:
 
@@ -29,6 +39,16 @@ namespace tc {
 			using pointer = element_type*;
 			using const_pointer = element_type const*;
 			using difference_type = typename std::pointer_traits<pointer>::difference_type;
+			using layout = Layout;
+
+			// View of the same elements in the other storage order, as returned by transposed().
+			using transpose_type = matrix_view<T, std::conditional_t<std::is_same_v<Layout, row_major>, column_major, row_major>>;
+
+
+			/* Member constants */
+
+			// Whether elements are viewed as row major.
+			static constexpr bool is_row_major = std::is_same_v<Layout, row_major>;
 
 
 			/* Special members */
@@ -40,7 +60,8 @@ namespace tc {
 			matrix_view() :
 				_data{nullptr},
 				_rows{0},
-				_columns{0}
+				_columns{0},
+				_stride{0}
 			{}
 
 			// Copy constructor.
@@ -53,9 +74,23 @@ namespace tc {
 			matrix_view(pointer data, size_type rows, size_type columns) :
 				_data{data},
 				_rows{rows},
-				_columns{columns}
+				_columns{columns},
+				_stride{is_row_major ? columns : rows}
 			{}
 
+			/* Constructor from pointer to array, dimensions and stride (leading dimension).
+				`stride` must be at least `columns` (row major) or `rows` (column major). */
+			matrix_view(pointer data, size_type rows, size_type columns, size_type stride) :
+				_data{data},
+				_rows{rows},
+				_columns{columns},
+				_stride{stride}
+			{
+				#ifdef _DEBUG
+					assert(stride >= (is_row_major ? columns : rows));
+				#endif
+			}
+
 
 			/* Operators */
 
@@ -73,11 +108,16 @@ namespace tc {
 					assert(row > 0 && row <= _rows);
 					assert(column > 0 && column <= _columns);
 				#endif
-				
-				return _data[((row - 1) * _columns) + (column - 1)];
+
+				if constexpr (is_row_major) {
+					return _data[((row - 1) * _stride) + (column - 1)];
+				}
+				else {
+					return _data[((column - 1) * _stride) + (row - 1)];
+				}
 			}
 
-			
+
 			/* General member functions */
 
 			// Gets the number of rows viewed.
@@ -86,12 +126,57 @@ namespace tc {
 				return _columns;
 			}
 
+			/* Gets a view of the specified column.
+				Bounds checked for debug builds. */
+			tc::vector_view::vector_view<T> column(size_type column) const
+			{
+				#ifdef _DEBUG
+					assert(column > 0 && column <= _columns);
+				#endif
+
+				return {_data + (column - 1) * column_stride(), _rows, row_stride()};
+			}
+
+			// Gets the number of elements between the starts of consecutive columns.
+			size_type column_stride() const
+			{
+				return is_row_major ? 1 : _stride;
+			}
+
 			// Gets the pointer to the start of the array.
 			pointer data() const
 			{
 				return _data;
 			}
 
+			// Checks whether the viewed elements are contiguous, ie whether there is no padding between rows (or columns).
+			bool is_contiguous() const
+			{
+				if constexpr (is_row_major) {
+					return _stride == _columns || _rows <= 1;
+				}
+				else {
+					return _stride == _rows || _columns <= 1;
+				}
+			}
+
+			/* Gets a view of the specified row.
+				Bounds checked for debug builds. */
+			tc::vector_view::vector_view<T> row(size_type row) const
+			{
+				#ifdef _DEBUG
+					assert(row > 0 && row <= _rows);
+				#endif
+
+				return {_data + (row - 1) * row_stride(), _columns, column_stride()};
+			}
+
+			// Gets the number of elements between the starts of consecutive rows.
+			size_type row_stride() const
+			{
+				return is_row_major ? _stride : 1;
+			}
+
 			// Gets the number of columns viewed.
 			size_type rows() const
 			{
@@ -104,6 +189,32 @@ namespace tc {
 				return _rows * _columns;
 			}
 
+			// Gets the number of elements between the starts of consecutive rows (row major) or columns (column major).
+			size_type stride() const
+			{
+				return _stride;
+			}
+
+			/* Gets a view of the `rows` x `columns` block whose top-left element is (`row`, `column`).
+				The block shares this view's stride, no elements are copied.
+				Bounds checked for debug builds. */
+			matrix_view submatrix(size_type row, size_type column, size_type rows, size_type columns) const
+			{
+				#ifdef _DEBUG
+					assert(row > 0 && row - 1 + rows <= _rows);
+					assert(column > 0 && column - 1 + columns <= _columns);
+				#endif
+
+				return {_data + ((row - 1) * row_stride()) + ((column - 1) * column_stride()), rows, columns, _stride};
+			}
+
+			/* Gets a view of the transpose of this matrix.
+				The same elements are viewed in the other storage order, no elements are copied. */
+			transpose_type transposed() const
+			{
+				return {_data, _columns, _rows, _stride};
+			}
+
 
 		private:
 
@@ -117,7 +228,28 @@ namespace tc {
 
 			// Number of viewed columns.
 			size_type _columns;
+
+			// Number of elements between the starts of consecutive rows (row major) or columns (column major).
+			size_type _stride;
 		};
 
+		// Column major matrix_view.
+		template<typename T>
+		using matrix_view_cm = matrix_view<T, column_major>;
+
+		/* std::true_type if Matrix stores its elements column major, otherwise std::false_type.
+			Matrix types without a `layout` member type alias are treated as row major. */
+		template<class Matrix, typename = void>
+		struct is_column_major : std::false_type {};
+
+		/* std::true_type if Matrix stores its elements column major, otherwise std::false_type.
+			Specialisation for matrix types with a `layout` member type alias. */
+		template<class Matrix>
+		struct is_column_major<Matrix, std::void_t<typename Matrix::layout>> : std::is_same<typename Matrix::layout, column_major> {};
+
+		// true if Matrix stores its elements column major, otherwise false.
+		template<class Matrix>
+		constexpr inline bool is_column_major_v = is_column_major<Matrix>::value;
+
 	}
 }
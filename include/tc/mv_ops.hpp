@@ -4,12 +4,14 @@
 	#include <cassert>		// assert
 #endif
 #include <cstddef>			// std::size_t
+#include "matrix_view.hpp"	// tc::matrix_view::is_column_major_v
 
 
 namespace tc {
 	namespace mv_ops {
 
-		// Matrix-vector multiplication (matrix by column vector).
+		/* Matrix-vector multiplication (matrix by column vector).
+			A column major `lhs` is walked down its columns, `result` accumulating each column scaled by an element of `rhs`. */
 		template<typename SizeType = std::size_t, class InputMatrix, class InputVector, class OutputVector>
 		void mv_mul(InputMatrix const& lhs, InputVector const& rhs, OutputVector& result)
 		{
@@ -18,16 +20,69 @@ namespace tc {
 				assert(lhs.rows() == result.size());
 			#endif
 			
+			if constexpr (tc::matrix_view::is_column_major_v<InputMatrix>) {
+				for (SizeType i = 1; i <= lhs.rows(); ++i) {
+					result(i) = typename OutputVector::value_type{};
+				}
+
+				for (SizeType j = 1; j <= lhs.columns(); ++j) {
+					auto const x = rhs(j);
+
+					for (SizeType i = 1; i <= lhs.rows(); ++i) {
+						result(i) += lhs(i, j) * x;
+					}
+				}
+				return;
+			}
+
 			for (SizeType i = 1; i <= lhs.rows(); ++i) {
-				result(i) = OutputVector::value_type{};
+				result(i) = typename OutputVector::value_type{};
 
 				for (SizeType j = 1; j <= lhs.columns(); ++j) {
 					result(i) += lhs(i, j) * rhs(j);
 				}
 			}
 		}
+
+		/* Matrix-vector multiplication (matrix by column vector), result = alpha lhs rhs + beta result.
+			`result` is not read when `beta` is zero. Walks `lhs` in its storage order, as mv_mul. */
+		template<typename SizeType = std::size_t, typename Element1, class InputMatrix, class InputVector, typename Element2, class OutputVector>
+		void mv_mul(Element1 const& alpha, InputMatrix const& lhs, InputVector const& rhs, Element2 const& beta, OutputVector& result)
+		{
+			#ifdef _DEBUG
+				assert(lhs.columns() == rhs.size());
+				assert(lhs.rows() == result.size());
+			#endif
+
+			using value_type = typename OutputVector::value_type;
+
+			if constexpr (tc::matrix_view::is_column_major_v<InputMatrix>) {
+				for (SizeType i = 1; i <= lhs.rows(); ++i) {
+					result(i) = beta == Element2{} ? value_type{} : beta * result(i);
+				}
+
+				for (SizeType j = 1; j <= lhs.columns(); ++j) {
+					auto const x = alpha * rhs(j);
+
+					for (SizeType i = 1; i <= lhs.rows(); ++i) {
+						result(i) += lhs(i, j) * x;
+					}
+				}
+				return;
+			}
+
+			for (SizeType i = 1; i <= lhs.rows(); ++i) {
+				value_type sum{};
+
+				for (SizeType j = 1; j <= lhs.columns(); ++j) {
+					sum += lhs(i, j) * rhs(j);
+				}
+				result(i) = beta == Element2{} ? alpha * sum : alpha * sum + beta * result(i);
+			}
+		}
 		
-		// Matrix-vector multiplication (matrix by column vector) (matrix transposed).
+		/* Matrix-vector multiplication (matrix by column vector) (matrix transposed).
+			A row major `lhs` is walked along its rows, `result` accumulating each row scaled by an element of `rhs`. */
 		template<typename SizeType = std::size_t, class InputMatrix, class InputVector, class OutputVector>
 		void mv_tmul(InputMatrix const& lhs, InputVector const& rhs, OutputVector& result)
 		{
@@ -36,8 +91,23 @@ namespace tc {
 				assert(lhs.columns() == result.size());
 			#endif
 			
+			if constexpr (!tc::matrix_view::is_column_major_v<InputMatrix>) {
+				for (SizeType j = 1; j <= lhs.columns(); ++j) {
+					result(j) = typename OutputVector::value_type{};
+				}
+
+				for (SizeType i = 1; i <= lhs.rows(); ++i) {
+					auto const x = rhs(i);
+
+					for (SizeType j = 1; j <= lhs.columns(); ++j) {
+						result(j) += lhs(i, j) * x;
+					}
+				}
+				return;
+			}
+
 			for (SizeType j = 1; j <= lhs.columns(); ++j) {
-				result(j) = OutputVector::value_type{};
+				result(j) = typename OutputVector::value_type{};
 				
 				for (SizeType i = 1; i <= lhs.rows(); ++i) {
 					result(j) += lhs(i, j) * rhs(i);
@@ -45,7 +115,45 @@ namespace tc {
 			}
 		}
 
-		// Vector-matrix multiplication (row vector by matrix).
+		/* Matrix-vector multiplication (matrix by column vector) (matrix transposed), result = alpha lhs^T rhs + beta result.
+			`result` is not read when `beta` is zero. Walks `lhs` in its storage order, as mv_tmul. */
+		template<typename SizeType = std::size_t, typename Element1, class InputMatrix, class InputVector, typename Element2, class OutputVector>
+		void mv_tmul(Element1 const& alpha, InputMatrix const& lhs, InputVector const& rhs, Element2 const& beta, OutputVector& result)
+		{
+			#ifdef _DEBUG
+				assert(lhs.rows() == rhs.size());
+				assert(lhs.columns() == result.size());
+			#endif
+
+			using value_type = typename OutputVector::value_type;
+
+			if constexpr (!tc::matrix_view::is_column_major_v<InputMatrix>) {
+				for (SizeType j = 1; j <= lhs.columns(); ++j) {
+					result(j) = beta == Element2{} ? value_type{} : beta * result(j);
+				}
+
+				for (SizeType i = 1; i <= lhs.rows(); ++i) {
+					auto const x = alpha * rhs(i);
+
+					for (SizeType j = 1; j <= lhs.columns(); ++j) {
+						result(j) += lhs(i, j) * x;
+					}
+				}
+				return;
+			}
+
+			for (SizeType j = 1; j <= lhs.columns(); ++j) {
+				value_type sum{};
+
+				for (SizeType i = 1; i <= lhs.rows(); ++i) {
+					sum += lhs(i, j) * rhs(i);
+				}
+				result(j) = beta == Element2{} ? alpha * sum : alpha * sum + beta * result(j);
+			}
+		}
+
+		/* Vector-matrix multiplication (row vector by matrix).
+			A row major `rhs` is walked along its rows, as in mv_tmul. */
 		template<typename SizeType = std::size_t, class InputVector, class InputMatrix, class OutputVector>
 		void vm_mul(InputVector const& lhs, InputMatrix const& rhs, OutputVector& result)
 		{
@@ -54,8 +162,13 @@ namespace tc {
 				assert(rhs.columns() == result.size());
 			#endif
 			
+			if constexpr (!tc::matrix_view::is_column_major_v<InputMatrix>) {
+				mv_tmul<SizeType>(rhs, lhs, result);
+				return;
+			}
+
 			for (SizeType j = 1; j <= rhs.columns(); ++j) {
-				result(j) = OutputVector::value_type{};
+				result(j) = typename OutputVector::value_type{};
 
 				for (SizeType i = 1; i <= lhs.size(); ++i) {
 					result(j) += lhs(i) * rhs(i, j);
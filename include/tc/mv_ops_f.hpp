@@ -1,10 +1,291 @@
 #pragma once
 
+#include <algorithm>		// std::fill, std::max, std::min
+#ifdef _DEBUG
+	#include <cassert>		// assert
+#endif
+#include <cstddef>			// std::size_t
+#include "math_f.hpp"		// tc::math_f::batch_fn
+#include "matrix_view.hpp"	// tc::matrix_view::is_column_major_v
+#include "mv_ops.hpp"		// tc::mv_ops::mv_mul, tc::mv_ops::mv_tmul
+#include "parallel.hpp"		// tc::parallel::for_each_chunk, tc::parallel::sum_range, tc::parallel::chunk_size
+#include "workspace.hpp"		// tc::workspace::scope
+
 
 namespace tc {
 	namespace mv_ops_f {
-		
-		
-		
+
+		// Narrowest column panel mv_tmul splits a matrix into, narrower matrices are split by row blocks instead.
+		constexpr inline std::size_t min_panel_columns = 512;
+
+		// Declared ahead of its definition, mv_mul and mv_tmul each hand column major matrices to the other.
+		template<typename SizeType = std::size_t, typename Element1, class InputMatrix, class InputVector, typename Element2, class OutputVector>
+		void mv_tmul(Element1 const& alpha, InputMatrix const& lhs, InputVector const& rhs, Element2 const& beta, OutputVector& result);
+
+		/* Matrix-vector multiplication (matrix by column vector), result = alpha lhs rhs + beta result.
+			Each result element is a multi-accumulator dot product of a row with `rhs`, blocks of rows are split across threads.
+			`result` is not read when `beta` is zero, so it need not be initialised.
+			A column major `lhs` is computed as mv_tmul of its (row major) transposed view, walking down its columns.
+			Falls back to tc::mv_ops::mv_mul if either vector is not contiguous. */
+		template<typename SizeType = std::size_t, typename Element1, class InputMatrix, class InputVector, typename Element2, class OutputVector>
+		void mv_mul(Element1 const& alpha, InputMatrix const& lhs, InputVector const& rhs, Element2 const& beta, OutputVector& result)
+		{
+			#ifdef _DEBUG
+				assert(lhs.columns() == rhs.size());
+				assert(lhs.rows() == result.size());
+			#endif
+
+			if constexpr (tc::matrix_view::is_column_major_v<InputMatrix>) {
+				mv_tmul<SizeType>(alpha, lhs.transposed(), rhs, beta, result);
+				return;
+			}
+
+			if (!rhs.is_contiguous() || !result.is_contiguous()) {
+				tc::mv_ops::mv_mul<SizeType>(alpha, lhs, rhs, beta, result);
+				return;
+			}
+
+			using value_type = typename OutputVector::value_type;
+
+			auto const a = lhs.data();
+			auto const x = rhs.data();
+			auto const y = result.data();
+			value_type const s = static_cast<value_type>(alpha);
+			value_type const t = static_cast<value_type>(beta);
+			std::size_t const columns = lhs.columns();
+			std::size_t const stride = lhs.stride();
+			std::size_t const rows_per_chunk = std::max<std::size_t>(tc::parallel::chunk_size / std::max<std::size_t>(columns, 1), 1);
+
+			tc::parallel::for_each_chunk(lhs.rows(), [=](std::size_t begin, std::size_t end) {
+				for (std::size_t i = begin; i < end; ++i) {
+					auto const row = a + i * stride;
+
+					value_type const sum = tc::parallel::sum_range<value_type>(0, columns, [=](std::size_t j) {
+						return static_cast<value_type>(row[j] * x[j]);
+					});
+					y[i] = t == value_type{} ? s * sum : s * sum + t * y[i];
+				}
+			}, rows_per_chunk);
+		}
+
+		/* Matrix-vector multiplication (matrix by column vector).
+			Computed as mv_mul with alpha one and beta zero. */
+		template<typename SizeType = std::size_t, class InputMatrix, class InputVector, class OutputVector>
+		void mv_mul(InputMatrix const& lhs, InputVector const& rhs, OutputVector& result)
+		{
+			using value_type = typename OutputVector::value_type;
+
+			mv_mul<SizeType>(value_type{1}, lhs, rhs, value_type{}, result);
+		}
+
+		/* Matrix-vector multiplication (matrix by column vector) (matrix transposed), result = alpha lhs^T rhs + beta result.
+			Computed as a sum of rows scaled by the elements of `rhs` (axpy form), so the matrix is streamed row by row
+			instead of walked down its columns. Wide matrices are split into column panels, one per task, each task
+			streaming its part of every row into its own part of `result`. Narrower matrices are split into blocks of rows
+			whose partial sums are added in order. `result` is scaled by `beta` first, and not read when `beta` is zero.
+			A column major `lhs` is computed as mv_mul of its (row major) transposed view, so its columns are read as rows.
+			Falls back to tc::mv_ops::mv_tmul if either vector is not contiguous. */
+		template<typename SizeType, typename Element1, class InputMatrix, class InputVector, typename Element2, class OutputVector>
+		void mv_tmul(Element1 const& alpha, InputMatrix const& lhs, InputVector const& rhs, Element2 const& beta, OutputVector& result)
+		{
+			#ifdef _DEBUG
+				assert(lhs.rows() == rhs.size());
+				assert(lhs.columns() == result.size());
+			#endif
+
+			if constexpr (tc::matrix_view::is_column_major_v<InputMatrix>) {
+				mv_mul<SizeType>(alpha, lhs.transposed(), rhs, beta, result);
+				return;
+			}
+
+			if (!rhs.is_contiguous() || !result.is_contiguous()) {
+				tc::mv_ops::mv_tmul<SizeType>(alpha, lhs, rhs, beta, result);
+				return;
+			}
+
+			using value_type = typename OutputVector::value_type;
+
+			auto const a = lhs.data();
+			auto const x = rhs.data();
+			auto const y = result.data();
+			value_type const s = static_cast<value_type>(alpha);
+			value_type const t = static_cast<value_type>(beta);
+			std::size_t const rows = lhs.rows();
+			std::size_t const columns = lhs.columns();
+			std::size_t const stride = lhs.stride();
+
+			// Adds rows [row_begin, row_end) scaled by alpha x into out[0, column_end - column_begin), four rows per pass.
+			auto const axpy_rows = [=](std::size_t row_begin, std::size_t row_end, std::size_t column_begin, std::size_t column_end, value_type* out) {
+				std::size_t const width = column_end - column_begin;
+				std::size_t i = row_begin;
+
+				for (; i + 4 <= row_end; i += 4) {
+					auto const r0 = a + i * stride + column_begin;
+					auto const r1 = r0 + stride;
+					auto const r2 = r1 + stride;
+					auto const r3 = r2 + stride;
+					value_type const x0 = s * x[i], x1 = s * x[i + 1], x2 = s * x[i + 2], x3 = s * x[i + 3];
+
+					for (std::size_t j = 0; j < width; ++j) {
+						out[j] += x0 * r0[j] + x1 * r1[j] + x2 * r2[j] + x3 * r3[j];
+					}
+				}
+				for (; i < row_end; ++i) {
+					auto const r0 = a + i * stride + column_begin;
+					value_type const x0 = s * x[i];
+
+					for (std::size_t j = 0; j < width; ++j) {
+						out[j] += x0 * r0[j];
+					}
+				}
+			};
+
+			if (t == value_type{}) {
+				std::fill(y, y + columns, value_type{});
+			}
+			else if (t != value_type{1}) {
+				for (std::size_t j = 0; j < columns; ++j) {
+					y[j] *= t;
+				}
+			}
+
+			if (columns >= 2 * min_panel_columns || rows * columns <= tc::parallel::chunk_size) {
+				std::size_t const panel = std::max(min_panel_columns, tc::parallel::chunk_size / std::max<std::size_t>(rows, 1));
+
+				tc::parallel::for_each_chunk(columns, [=](std::size_t begin, std::size_t end) {
+					axpy_rows(0, rows, begin, end, y + begin);
+				}, panel);
+			}
+			else {
+				std::size_t const rows_per_block = std::max<std::size_t>(tc::parallel::chunk_size / columns, 1);
+				std::size_t const blocks = (rows + rows_per_block - 1) / rows_per_block;
+				tc::workspace::scope scratch;
+				value_type* const partial = scratch.allocate<value_type>(blocks * columns);
+
+				std::fill(partial, partial + blocks * columns, value_type{});
+				tc::parallel::for_each_chunk(rows, [&](std::size_t begin, std::size_t end) {
+					axpy_rows(begin, end, 0, columns, partial + (begin / rows_per_block) * columns);
+				}, rows_per_block);
+
+				for (std::size_t b = 0; b < blocks; ++b) {
+					value_type const* p = partial + b * columns;
+
+					for (std::size_t j = 0; j < columns; ++j) {
+						y[j] += p[j];
+					}
+				}
+			}
+		}
+
+		/* Matrix-vector multiplication (matrix by column vector) (matrix transposed).
+			Computed as mv_tmul with alpha one and beta zero. */
+		template<typename SizeType = std::size_t, class InputMatrix, class InputVector, class OutputVector>
+		void mv_tmul(InputMatrix const& lhs, InputVector const& rhs, OutputVector& result)
+		{
+			using value_type = typename OutputVector::value_type;
+
+			mv_tmul<SizeType>(value_type{1}, lhs, rhs, value_type{}, result);
+		}
+
+		/* Vector-matrix multiplication (row vector by matrix).
+			Same computation as mv_tmul, `rhs` is streamed row by row (column by column if column major). */
+		template<typename SizeType = std::size_t, class InputVector, class InputMatrix, class OutputVector>
+		void vm_mul(InputVector const& lhs, InputMatrix const& rhs, OutputVector& result)
+		{
+			#ifdef _DEBUG
+				assert(lhs.size() == rhs.rows());
+				assert(rhs.columns() == result.size());
+			#endif
+
+			mv_tmul<SizeType>(rhs, lhs, result);
+		}
+
+		/* Batched matrix-vector multiplication, result[b] = lhs[b] rhs[b] for every b in [0, lhs.size()).
+			`lhs` is a sequence of matrices, `rhs` and `result` sequences of vectors (anything with size() and operator[]),
+			the products are independent and may differ in shape. The batch is split across threads, each product is
+			computed on one thread by mv_mul, whose own parallel loop runs serially inside the batch's. */
+		template<typename SizeType = std::size_t, class InputMatrices, class InputVectors, class OutputVectors>
+		void mv_mul_batched(InputMatrices const& lhs, InputVectors const& rhs, OutputVectors& result)
+		{
+			#ifdef _DEBUG
+				assert(lhs.size() == rhs.size());
+				assert(lhs.size() == result.size());
+			#endif
+
+			if (lhs.size() == 0) {
+				return;
+			}
+
+			// Enough products per task to amortise scheduling, judged by the size of the first.
+			std::size_t const products_per_chunk = std::max<std::size_t>(tc::parallel::chunk_size / std::max<std::size_t>(lhs[0].size(), 1), 1);
+
+			tc::parallel::for_each_chunk(lhs.size(), [&](std::size_t begin, std::size_t end) {
+				for (std::size_t i = begin; i < end; ++i) {
+					auto y = result[i];
+
+					mv_mul<SizeType>(lhs[i], rhs[i], y);
+				}
+			}, products_per_chunk);
+		}
+
+		/* Dense layer forward pass, result = activation(weights input + bias), with `activation` applied elementwise.
+			For a row major `weights`, each block of rows is multiplied, biased and activated while it is in cache, so `result`
+			is written once. A column major `weights` is multiplied by mv_mul, then biased and activated in one further pass.
+			`activation` goes through the batch kernels of tc::math_f when it is one of their functions (see tc::math_f::batch_fn).
+			The sums are bitwise identical to mv_mul followed by adding `bias`.
+			Falls back to tc::mv_ops::mv_mul and an elementwise pass if a vector is not contiguous. */
+		template<typename SizeType = std::size_t, class InputMatrix, class InputVector1, class InputVector2, typename Function, class OutputVector>
+		void dense_forward(InputMatrix const& weights, InputVector1 const& input, InputVector2 const& bias, Function activation, OutputVector& result)
+		{
+			#ifdef _DEBUG
+				assert(weights.columns() == input.size());
+				assert(weights.rows() == result.size());
+				assert(bias.size() == result.size());
+			#endif
+
+			if (!input.is_contiguous() || !bias.is_contiguous() || !result.is_contiguous()) {
+				tc::mv_ops::mv_mul<SizeType>(weights, input, result);
+
+				for (SizeType i = 1; i <= result.size(); ++i) {
+					result(i) = activation(result(i) + bias(i));
+				}
+				return;
+			}
+
+			using value_type = typename OutputVector::value_type;
+
+			auto const x = input.data();
+			auto const c = bias.data();
+			auto const y = result.data();
+
+			if constexpr (tc::matrix_view::is_column_major_v<InputMatrix>) {
+				mv_mul<SizeType>(weights, input, result);
+
+				tc::parallel::for_each_chunk(result.size(), [&](std::size_t begin, std::size_t end) {
+					for (std::size_t i = begin; i < end; ++i) {
+						y[i] += c[i];
+					}
+					tc::math_f::batch_fn(y + begin, end - begin, y + begin, activation);
+				});
+			}
+			else {
+				auto const a = weights.data();
+				std::size_t const columns = weights.columns();
+				std::size_t const stride = weights.stride();
+				std::size_t const rows_per_chunk = std::max<std::size_t>(tc::parallel::chunk_size / std::max<std::size_t>(columns, 1), 1);
+
+				tc::parallel::for_each_chunk(weights.rows(), [&](std::size_t begin, std::size_t end) {
+					for (std::size_t i = begin; i < end; ++i) {
+						auto const row = a + i * stride;
+
+						y[i] = tc::parallel::sum_range<value_type>(0, columns, [=](std::size_t j) {
+							return static_cast<value_type>(row[j] * x[j]);
+						}) + c[i];
+					}
+					tc::math_f::batch_fn(y + begin, end - begin, y + begin, activation);
+				}, rows_per_chunk);
+			}
+		}
+
 	}
 }
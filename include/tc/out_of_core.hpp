@@ -0,0 +1,283 @@
+#pragma once
+
+#include <algorithm>				// std::copy_n, std::fill_n, std::max, std::min
+#ifdef _DEBUG
+	#include <cassert>				// assert
+#endif
+#include <cmath>					// std::sqrt
+#include <cstddef>					// std::size_t
+#include <future>					// std::async, std::future, std::launch
+#include <limits>					// std::numeric_limits
+#include <stdexcept>				// std::invalid_argument
+#include <string>					// std::string
+#include <vector>					// std::vector
+#include "aligned.hpp"				// tc::aligned::allocate, tc::aligned::unique_array
+#include "io.hpp"					// tc::io::advice, tc::io::create_matrix, tc::io::map_matrix
+#include "matrix_ops_f.hpp"			// tc::matrix_ops_f::mm_mul
+#include "matrix_view.hpp"			// tc::matrix_view::matrix_view, tc::matrix_view::row_major
+
+
+namespace tc {
+	namespace out_of_core {
+
+		/* Operations on matrices too big to hold in memory, typically mapped from files (see tc::io).
+			Operands are walked in tiles copied into buffers of bounded total size, so each tile is read from disk once
+			per use and the working set stays in memory while it is computed on. */
+
+		// Sizes of the tiles of a product, see plan.
+		struct tiling {
+			// Rows of each tile of the result and of the lhs panels.
+			std::size_t rows;
+
+			// Columns of each tile of the result and of the rhs panels.
+			std::size_t columns;
+
+			// Columns of the lhs panels and rows of the rhs panels.
+			std::size_t depth;
+		};
+
+		// Depth of panels the tile sizes are planned for, enough for the in-memory kernel to run at full speed.
+		constexpr inline std::size_t planned_depth = 256;
+
+		/* Plans the tiles of an `m` by `k` times `k` by `n` product held in `budget` elements of buffers: one result tile
+			and two of each operand panel (one computed on, one being read), rows columns + 2 depth (rows + columns).
+			Each panel of the lhs is read n / columns times and each panel of the rhs m / rows times, so the result tile
+			is made as large and as square as fits beside panels of planned_depth (shallower for small budgets), then the
+			panels are deepened into any budget left over, which means fewer, larger reads.
+			Throws std::invalid_argument if `budget` is less than 5, one element of each buffer. */
+		inline tiling plan(std::size_t m, std::size_t n, std::size_t k, std::size_t budget)
+		{
+			if (budget < 5) {
+				throw std::invalid_argument{"tc::out_of_core: memory budget too small"};
+			}
+
+			m = std::max<std::size_t>(m, 1);
+			n = std::max<std::size_t>(n, 1);
+			k = std::max<std::size_t>(k, 1);
+
+			// Panels no deeper than a quarter of the square root of the budget, so small budgets still get square tiles.
+			std::size_t const quarter_root = static_cast<std::size_t>(std::sqrt(static_cast<double>(budget))) / 4;
+
+			// Largest square tile s with s^2 + 4 d s <= budget.
+			double const d = static_cast<double>(std::min({k, planned_depth, std::max<std::size_t>(quarter_root, 1)}));
+			std::size_t side = static_cast<std::size_t>(std::sqrt(4 * d * d + static_cast<double>(budget)) - 2 * d);
+
+			while (side > 1 && side * side + 4 * static_cast<std::size_t>(d) * side > budget) {
+				--side;
+			}
+
+			// A side clipped by a dimension of the result leaves room to lengthen the other.
+			std::size_t const depth = static_cast<std::size_t>(d);
+			std::size_t rows = std::min(m, std::max<std::size_t>(side, 1));
+			std::size_t const columns = std::min(n, (budget - 2 * depth * rows) / (rows + 2 * depth));
+
+			rows = std::min(m, (budget - 2 * depth * columns) / (columns + 2 * depth));
+
+			return {rows, columns, std::min(k, (budget - rows * columns) / (2 * (rows + columns)))};
+		}
+
+		/* Copies the `rows` by `columns` block of `source` at 0-indexed (`row`, `column`) to `buffer`, contiguous in the
+			storage order of `source`. */
+		template<class InputMatrix>
+		void load_tile(InputMatrix const& source, std::size_t row, std::size_t column, std::size_t rows, std::size_t columns, typename InputMatrix::value_type* buffer)
+		{
+			constexpr bool is_row_major = InputMatrix::is_row_major;
+
+			std::size_t const lines = is_row_major ? rows : columns;
+			std::size_t const length = is_row_major ? columns : rows;
+			auto const first = source.data() + row * source.row_stride() + column * source.column_stride();
+
+			for (std::size_t l = 0; l < lines; ++l) {
+				std::copy_n(first + l * source.stride(), length, buffer + l * length);
+			}
+		}
+
+		/* Copies `buffer`, contiguous in the storage order of `result`, to the `rows` by `columns` block of `result` at
+			0-indexed (`row`, `column`). */
+		template<class OutputMatrix>
+		void store_tile(typename OutputMatrix::value_type const* buffer, std::size_t row, std::size_t column, std::size_t rows, std::size_t columns, OutputMatrix& result)
+		{
+			constexpr bool is_row_major = OutputMatrix::is_row_major;
+
+			std::size_t const lines = is_row_major ? rows : columns;
+			std::size_t const length = is_row_major ? columns : rows;
+			auto const first = result.data() + row * result.row_stride() + column * result.column_stride();
+
+			for (std::size_t l = 0; l < lines; ++l) {
+				std::copy_n(buffer + l * length, length, first + l * result.stride());
+			}
+		}
+
+		/* Matrix-matrix multiplication, result = lhs rhs, holding at most `budget` bytes of operand and result tiles.
+			The matrices are tc::matrix_view::matrix_view objects of any storage order, typically mapped from files with
+			tc::io::map_matrix and tc::io::create_matrix, so only the tiles being worked on need be in memory.
+			Tiles are sized by plan. Each tile of the result stays in memory while panels of lhs and rhs are streamed
+			through it and multiplied in by tc::matrix_ops_f::mm_mul, then it is written to `result`. The panels are walked
+			forwards and backwards in turn, so the last panel of one tile is the first of the next and is not read again.
+			While each step is computed, a background thread reads the next step's panels into the second buffer, so
+			page faults on the files overlap the arithmetic.
+			The bound covers the tile buffers, not the kernel's packing scratch (see tc::workspace) nor the pages of
+			mapped files, which the kernel can drop once they are written back.
+			Throws std::invalid_argument if `budget` cannot hold one element of each buffer. */
+		template<class InputMatrix1, class InputMatrix2, class OutputMatrix>
+		void mm_mul(InputMatrix1 const& lhs, InputMatrix2 const& rhs, OutputMatrix& result, std::size_t budget)
+		{
+			#ifdef _DEBUG
+				assert(lhs.columns() == rhs.rows());
+				assert(lhs.rows() == result.rows());
+				assert(rhs.columns() == result.columns());
+			#endif
+
+			using value_type = typename OutputMatrix::value_type;
+			using lhs_view = tc::matrix_view::matrix_view<value_type const, typename InputMatrix1::layout>;
+			using rhs_view = tc::matrix_view::matrix_view<value_type const, typename InputMatrix2::layout>;
+			using result_view = tc::matrix_view::matrix_view<value_type, typename OutputMatrix::layout>;
+
+			// Unloaded panel position.
+			constexpr std::size_t none = std::numeric_limits<std::size_t>::max();
+
+			// Step of the product, one panel of each operand multiplied into one tile of the result.
+			struct step {
+				std::size_t row;
+				std::size_t column;
+				std::size_t inner;
+				bool first;
+				bool last;
+			};
+
+			std::size_t const m = lhs.rows();
+			std::size_t const n = rhs.columns();
+			std::size_t const k = lhs.columns();
+
+			tiling const tiles = plan(m, n, k, budget / sizeof(value_type));
+
+			if (m == 0 || n == 0) {
+				return;
+			}
+
+			tc::aligned::unique_array<value_type> const tile = tc::aligned::allocate<value_type>(tiles.rows * tiles.columns);
+
+			if (k == 0) {
+				std::fill_n(tile.get(), tiles.rows * tiles.columns, value_type{});
+
+				for (std::size_t j = 0; j < n; j += tiles.columns) {
+					for (std::size_t i = 0; i < m; i += tiles.rows) {
+						store_tile(tile.get(), i, j, std::min(tiles.rows, m - i), std::min(tiles.columns, n - j), result);
+					}
+				}
+				return;
+			}
+
+			std::vector<step> steps;
+			bool forwards = true;
+
+			for (std::size_t j = 0; j < n; j += tiles.columns) {
+				for (std::size_t i = 0; i < m; i += tiles.rows) {
+					std::size_t const panels = (k + tiles.depth - 1) / tiles.depth;
+
+					for (std::size_t p = 0; p < panels; ++p) {
+						std::size_t const inner = (forwards ? p : panels - 1 - p) * tiles.depth;
+
+						steps.push_back({i, j, inner, p == 0, p == panels - 1});
+					}
+					forwards = !forwards;
+				}
+			}
+
+			// Two buffers of each operand, the panel in each, and which one the current step uses.
+			tc::aligned::unique_array<value_type> const lhs_buffers[2]{
+				tc::aligned::allocate<value_type>(tiles.rows * tiles.depth),
+				tc::aligned::allocate<value_type>(tiles.rows * tiles.depth)
+			};
+			tc::aligned::unique_array<value_type> const rhs_buffers[2]{
+				tc::aligned::allocate<value_type>(tiles.depth * tiles.columns),
+				tc::aligned::allocate<value_type>(tiles.depth * tiles.columns)
+			};
+			step lhs_panels[2]{{none, none, none, false, false}, {none, none, none, false, false}};
+			step rhs_panels[2]{{none, none, none, false, false}, {none, none, none, false, false}};
+			std::size_t lhs_current = 0;
+			std::size_t rhs_current = 0;
+
+			// Chooses the buffers for step `s`, reusing those already holding its panels, and reads the panels missing.
+			auto const load = [&](step const& s, std::size_t& lhs_slot, std::size_t& rhs_slot) {
+				std::size_t const rows = std::min(tiles.rows, m - s.row);
+				std::size_t const columns = std::min(tiles.columns, n - s.column);
+				std::size_t const depth = std::min(tiles.depth, k - s.inner);
+
+				bool const lhs_loaded = lhs_panels[lhs_current].row == s.row && lhs_panels[lhs_current].inner == s.inner;
+				bool const rhs_loaded = rhs_panels[rhs_current].column == s.column && rhs_panels[rhs_current].inner == s.inner;
+
+				lhs_slot = lhs_loaded ? lhs_current : 1 - lhs_current;
+				rhs_slot = rhs_loaded ? rhs_current : 1 - rhs_current;
+
+				return [&, s, rows, columns, depth, lhs_loaded, rhs_loaded, lhs_slot, rhs_slot] {
+					if (!lhs_loaded) {
+						load_tile(lhs, s.row, s.inner, rows, depth, lhs_buffers[lhs_slot].get());
+						lhs_panels[lhs_slot] = s;
+					}
+					if (!rhs_loaded) {
+						load_tile(rhs, s.inner, s.column, depth, columns, rhs_buffers[rhs_slot].get());
+						rhs_panels[rhs_slot] = s;
+					}
+				};
+			};
+
+			std::size_t lhs_next;
+			std::size_t rhs_next;
+
+			load(steps.front(), lhs_next, rhs_next)();
+
+			for (std::size_t t = 0; t < steps.size(); ++t) {
+				step const& s = steps[t];
+
+				lhs_current = lhs_next;
+				rhs_current = rhs_next;
+
+				// Reads the next step's panels into the other buffers while this one is computed.
+				std::future<void> pending;
+
+				if (t + 1 < steps.size()) {
+					pending = std::async(std::launch::async, load(steps[t + 1], lhs_next, rhs_next));
+				}
+
+				std::size_t const rows = std::min(tiles.rows, m - s.row);
+				std::size_t const columns = std::min(tiles.columns, n - s.column);
+				std::size_t const depth = std::min(tiles.depth, k - s.inner);
+
+				lhs_view const a{lhs_buffers[lhs_current].get(), rows, depth};
+				rhs_view const b{rhs_buffers[rhs_current].get(), depth, columns};
+				result_view c{tile.get(), rows, columns};
+
+				tc::matrix_ops_f::mm_mul(value_type{1}, a, b, s.first ? value_type{} : value_type{1}, c);
+
+				if (s.last) {
+					store_tile(tile.get(), s.row, s.column, rows, columns, result);
+				}
+
+				if (pending.valid()) {
+					pending.get();
+				}
+			}
+		}
+
+		/* Matrix-matrix multiplication of matrix files, writes lhs rhs to a new matrix file `result_path`, holding at most
+			`budget` bytes of tiles (see mm_mul above).
+			All three files hold elements of type T in storage order `Layout` (see tc::io). */
+		template<typename T, typename Layout = tc::matrix_view::row_major>
+		void mm_mul(std::string const& lhs_path, std::string const& rhs_path, std::string const& result_path, std::size_t budget)
+		{
+			auto const lhs = tc::io::map_matrix<T const, Layout>(lhs_path);
+			auto const rhs = tc::io::map_matrix<T const, Layout>(rhs_path);
+
+			if (lhs->columns() != rhs->rows()) {
+				throw std::invalid_argument{"tc::out_of_core: inner dimensions differ"};
+			}
+
+			auto const result = tc::io::create_matrix<T, Layout>(result_path, lhs->rows(), rhs->columns(), tc::io::advice::normal);
+			auto c = result.view();
+
+			mm_mul(lhs.view(), rhs.view(), c, budget);
+		}
+
+	}
+}
@@ -0,0 +1,427 @@
+#pragma once
+
+#include <algorithm>		// std::max, std::min
+#include <atomic>			// std::atomic
+#ifdef _DEBUG
+	#include <cassert>		// assert
+#endif
+#include <condition_variable>	// std::condition_variable
+#include <cstddef>			// std::size_t
+#include <cstdint>			// std::uint32_t, std::uint64_t
+#include <exception>		// std::current_exception, std::exception_ptr, std::rethrow_exception
+#include <memory>			// std::unique_ptr
+#include <mutex>			// std::mutex, std::unique_lock, std::lock_guard
+#include <thread>			// std::thread
+#include <utility>			// std::exchange
+#include <vector>			// std::vector
+#include "workspace.hpp"		// tc::workspace::scope
+
+
+namespace tc {
+	namespace parallel {
+
+		/* Persistent pool of worker threads with a work-stealing task scheduler.
+			A job is a range of task indices [0, tasks), split evenly between the participating threads up front.
+			Each thread takes tasks from the front of its own range, and once that is empty steals the back half
+			of another thread's range, so unevenly sized tasks still balance across threads.
+			The calling thread takes part in every job.
+			If tasks throw, the first exception is rethrown on the calling thread once every participant has stopped, and
+			the tasks not yet started are skipped. */
+		class thread_pool {
+		public:
+
+			/* Member type aliases */
+
+			using size_type = std::size_t;
+
+
+			/* Special members */
+
+			// Destructor, joins all worker threads.
+			~thread_pool()
+			{
+				{
+					std::lock_guard<std::mutex> lock{_mutex};
+					_stop = true;
+				}
+				_start.notify_all();
+
+				for (auto& thread : _threads) {
+					thread.join();
+				}
+			}
+
+			// Constructor from total number of threads, including the calling thread.
+			explicit thread_pool(size_type threads) :
+				_ranges{new std::atomic<std::uint64_t>[std::max<size_type>(threads, 1)]},
+				_size{std::max<size_type>(threads, 1)}
+			{
+				for (size_type i = 0; i < _size; ++i) {
+					_ranges[i].store(pack(0, 0), std::memory_order_relaxed);
+				}
+
+				for (size_type i = 1; i < _size; ++i) {
+					_threads.emplace_back([this, i]{ worker(i); });
+				}
+			}
+
+			thread_pool(thread_pool const&) = delete;
+			thread_pool& operator=(thread_pool const&) = delete;
+
+
+			/* General member functions */
+
+			// Process-wide pool, sized to the hardware concurrency.
+			static thread_pool& instance()
+			{
+				static thread_pool pool{std::max<size_type>(std::thread::hardware_concurrency(), 1)};
+				return pool;
+			}
+
+			// Number of threads taking part in a job, including the calling thread.
+			size_type size() const
+			{
+				return _size;
+			}
+
+			/* Calls function(task) once for every task in [0, tasks), spread across the pool.
+				Returns once every task has completed. If a task throws, the remaining tasks are skipped and the first
+				exception is rethrown here once no thread is still running the job.
+				Runs serially on the calling thread if called from inside a job or while another thread's job is running. */
+			template<typename Function>
+			void run(size_type tasks, Function& function)
+			{
+				#ifdef _DEBUG
+					assert(tasks <= UINT32_MAX);
+				#endif
+
+				if (tasks == 0) {
+					return;
+				}
+
+				std::unique_lock<std::mutex> run_lock{_run_mutex, std::try_to_lock};
+
+				if (tasks == 1 || _size == 1 || in_job() || !run_lock.owns_lock()) {
+					for (size_type task = 0; task < tasks; ++task) {
+						function(task);
+					}
+					return;
+				}
+
+				for (size_type i = 0; i < _size; ++i) {
+					size_type const begin = tasks * i / _size;
+					size_type const end = tasks * (i + 1) / _size;
+					_ranges[i].store(pack(begin, end), std::memory_order_relaxed);
+				}
+
+				{
+					std::lock_guard<std::mutex> lock{_mutex};
+					_invoke = [](void* f, size_type task){ (*static_cast<Function*>(f))(task); };
+					_function = &function;
+					_active = _size - 1;
+					_exception = nullptr;
+					_failed.store(false, std::memory_order_relaxed);
+					++_generation;
+				}
+				_start.notify_all();
+
+				{
+					job_scope const job;
+					execute(0);
+				}
+
+				std::exception_ptr exception;
+
+				{
+					std::unique_lock<std::mutex> lock{_mutex};
+					_done.wait(lock, [this]{ return _active == 0; });
+					exception = std::exchange(_exception, nullptr);
+				}
+
+				if (exception) {
+					std::rethrow_exception(exception);
+				}
+			}
+
+
+		private:
+
+			/* Member types */
+
+			// Marks the current thread as running a task of a job for its lifetime, see in_job.
+			struct job_scope {
+				job_scope()
+				{
+					in_job() = true;
+				}
+
+				~job_scope()
+				{
+					in_job() = false;
+				}
+
+				job_scope(job_scope const&) = delete;
+				job_scope& operator=(job_scope const&) = delete;
+			};
+
+
+			/* Member functions */
+
+			// Packs a task range into one word, so it can be updated with a single compare-exchange.
+			static std::uint64_t pack(size_type begin, size_type end)
+			{
+				return (static_cast<std::uint64_t>(begin) << 32) | static_cast<std::uint64_t>(end);
+			}
+
+			// Whether the current thread is running a task of some job.
+			static bool& in_job()
+			{
+				thread_local bool flag = false;
+				return flag;
+			}
+
+			// Takes the first task of a participant's own range.
+			bool pop(size_type participant, size_type& task)
+			{
+				std::atomic<std::uint64_t>& range = _ranges[participant];
+				std::uint64_t current = range.load(std::memory_order_acquire);
+
+				for (;;) {
+					std::uint32_t const begin = static_cast<std::uint32_t>(current >> 32);
+					std::uint32_t const end = static_cast<std::uint32_t>(current);
+
+					if (begin >= end) {
+						return false;
+					}
+
+					if (range.compare_exchange_weak(current, pack(begin + 1, end), std::memory_order_acq_rel)) {
+						task = begin;
+						return true;
+					}
+				}
+			}
+
+			// Steals the back half (rounded up) of a victim's range.
+			bool steal(size_type victim, size_type& begin, size_type& end)
+			{
+				std::atomic<std::uint64_t>& range = _ranges[victim];
+				std::uint64_t current = range.load(std::memory_order_acquire);
+
+				for (;;) {
+					std::uint32_t const b = static_cast<std::uint32_t>(current >> 32);
+					std::uint32_t const e = static_cast<std::uint32_t>(current);
+
+					if (b >= e) {
+						return false;
+					}
+
+					std::uint32_t const split = b + (e - b) / 2;
+
+					if (range.compare_exchange_weak(current, pack(b, split), std::memory_order_acq_rel)) {
+						begin = split;
+						end = e;
+						return true;
+					}
+				}
+			}
+
+			/* Runs tasks for one participant until no range has work left.
+				The first exception thrown by a task is kept for run to rethrow, and the tasks after it are skipped. */
+			void execute(size_type participant)
+			{
+				for (;;) {
+					size_type task;
+
+					while (pop(participant, task)) {
+						if (_failed.load(std::memory_order_relaxed)) {
+							continue;
+						}
+
+						try {
+							_invoke(_function, task);
+						}
+						catch (...) {
+							std::lock_guard<std::mutex> lock{_mutex};
+
+							if (!_exception) {
+								_exception = std::current_exception();
+							}
+							_failed.store(true, std::memory_order_relaxed);
+						}
+					}
+
+					bool stolen = false;
+
+					for (size_type i = 1; i < _size && !stolen; ++i) {
+						size_type begin, end;
+
+						if (steal((participant + i) % _size, begin, end)) {
+							_ranges[participant].store(pack(begin, end), std::memory_order_release);
+							stolen = true;
+						}
+					}
+
+					if (!stolen) {
+						return;
+					}
+				}
+			}
+
+			// Worker thread main loop.
+			void worker(size_type participant)
+			{
+				size_type seen = 0;
+
+				for (;;) {
+					{
+						std::unique_lock<std::mutex> lock{_mutex};
+						_start.wait(lock, [&]{ return _stop || _generation != seen; });
+
+						if (_stop) {
+							return;
+						}
+
+						seen = _generation;
+					}
+
+					{
+						job_scope const job;
+						execute(participant);
+					}
+
+					{
+						std::lock_guard<std::mutex> lock{_mutex};
+						--_active;
+					}
+					_done.notify_one();
+				}
+			}
+
+
+			/* Member variables */
+
+			// Remaining task range of each participant, packed by pack().
+			std::unique_ptr<std::atomic<std::uint64_t>[]> _ranges;
+
+			// Number of participants, including the calling thread.
+			size_type _size;
+
+			// Worker threads (participants 1 to _size - 1).
+			std::vector<std::thread> _threads;
+
+			// Serialises jobs.
+			std::mutex _run_mutex;
+
+			// Guards the job state below.
+			std::mutex _mutex;
+			std::condition_variable _start;
+			std::condition_variable _done;
+
+			// Type-erased task function of the current job.
+			void (*_invoke)(void*, size_type) = nullptr;
+			void* _function = nullptr;
+
+			// First exception thrown by a task of the current job.
+			std::exception_ptr _exception;
+
+			// Set once a task of the current job has thrown, so the remaining tasks are skipped.
+			std::atomic<bool> _failed{false};
+
+			// Number of worker threads still running the current job.
+			size_type _active = 0;
+
+			// Incremented for every job, wakes the workers.
+			size_type _generation = 0;
+
+			// Set on destruction.
+			bool _stop = false;
+		};
+
+		// Number of threads used by the parallel kernels.
+		inline std::size_t thread_count()
+		{
+			return thread_pool::instance().size();
+		}
+
+		/* Calls function(task) for every task in [0, tasks) on the shared thread pool, with work stealing.
+			Returns once all tasks have completed. */
+		template<typename Function>
+		void for_each_task(std::size_t tasks, Function function)
+		{
+			thread_pool::instance().run(tasks, function);
+		}
+
+
+		// Elements handled by each task of the chunked kernels. Inputs up to this size run serially.
+		constexpr inline std::size_t chunk_size = std::size_t{1} << 15;
+
+		/* Calls function(begin, end) for consecutive chunks of [0, n) of at most `chunk` elements.
+			Chunks run on the shared thread pool if there is more than one, otherwise on the calling thread. */
+		template<typename Function>
+		void for_each_chunk(std::size_t n, Function function, std::size_t chunk = chunk_size)
+		{
+			if (n <= chunk) {
+				if (n > 0) {
+					function(std::size_t{0}, n);
+				}
+				return;
+			}
+
+			for_each_task((n + chunk - 1) / chunk, [&](std::size_t task) {
+				std::size_t const begin = task * chunk;
+				function(begin, std::min(begin + chunk, n));
+			});
+		}
+
+		/* Serial sum of term(i) over [begin, end).
+			Uses several independent accumulators so the loop vectorises and is not bound by the add latency,
+			they are combined pairwise at the end. */
+		template<typename T, typename Term>
+		T sum_range(std::size_t begin, std::size_t end, Term term)
+		{
+			constexpr std::size_t lanes = 16;
+
+			T acc[lanes] = {};
+			std::size_t i = begin;
+
+			for (; i + lanes <= end; i += lanes) {
+				for (std::size_t j = 0; j < lanes; ++j) {
+					acc[j] += term(i + j);
+				}
+			}
+			for (std::size_t j = 0; i < end; ++i, ++j) {
+				acc[j] += term(i);
+			}
+
+			for (std::size_t width = lanes / 2; width > 0; width /= 2) {
+				for (std::size_t j = 0; j < width; ++j) {
+					acc[j] += acc[j + width];
+				}
+			}
+
+			return acc[0];
+		}
+
+		/* Sum of term(i) over [0, n).
+			Each chunk of chunk_size elements is summed by sum_range on the thread pool, then the chunk sums are added in order.
+			The chunking does not depend on the number of threads, so neither does the result. */
+		template<typename T, typename Term>
+		T sum(std::size_t n, Term term)
+		{
+			if (n <= chunk_size) {
+				return sum_range<T>(0, n, term);
+			}
+
+			std::size_t const chunks = (n + chunk_size - 1) / chunk_size;
+			tc::workspace::scope scratch;
+			T* const partial = scratch.allocate<T>(chunks);
+
+			for_each_chunk(n, [&](std::size_t begin, std::size_t end) {
+				partial[begin / chunk_size] = sum_range<T>(begin, end, term);
+			});
+
+			return sum_range<T>(0, chunks, [&](std::size_t i){ return partial[i]; });
+		}
+
+	}
+}
@@ -1,16 +1,30 @@
 #pragma once
 
+#include <algorithm>		// std::copy_n, std::max, std::min
+#include <array>			// std::array
+#ifdef _DEBUG
+	#include <cassert>		// assert
+#endif
 #include <chrono>			// std::system_clock
+#include <cstddef>			// std::size_t
+#include <cstdint>			// std::uint32_t, std::uint64_t
 #include <limits>			// std::numeric_limits
 #include <random>			// std::mt19937_64, std::random_device, std::uniform_int_distribution, std::uniform_real_distribution, std::normal_distribution
-#include <type_traits>		// std::enable_if_t, std::is_floating_point_v, std::is_integral_v, std::conditional_t, std::is_signed_v, std::is_same_v
+#include <type_traits>		// std::enable_if_t, std::is_floating_point_v, std::is_integral_v, std::conditional_t, std::is_signed_v, std::is_same_v, std::false_type, std::true_type, std::void_t
+#include <utility>			// std::declval
+#include "math_f.hpp"		// tc::math_f::float_traits, tc::math_f::from_bits, tc::math_f::log, tc::math_f::polynomial, tc::math_f::round, tc::math_f::to_bits
+#include "parallel.hpp"		// tc::parallel::chunk_size, tc::parallel::for_each_chunk
+#include "vector_view.hpp"	// tc::vector_view::vector_view
+#include "workspace.hpp"	// tc::workspace::scope
 
 
 namespace tc {
 	namespace random {
 		
-		// Generic pseudorandom engine, seeded (hopefully) randomly.
-		static std::mt19937_64 generic_rand(std::random_device{}() + std::chrono::system_clock::now().time_since_epoch().count());
+		/* Generic pseudorandom engine, seeded (hopefully) randomly.
+			One engine per thread, so the functions below can be called concurrently. Their results are not reproducible,
+			use philox for that. */
+		static thread_local std::mt19937_64 generic_rand(std::random_device{}() + std::chrono::system_clock::now().time_since_epoch().count());
 		
 		/* Generates a uniformly distributed random floating point value.
 			The random value is generated with generic_rand and std::uniform_real_distribution. */
@@ -63,5 +77,470 @@ namespace tc {
 			return dist(generic_rand);
 		}
 		
+		/* Philox4x32-10 block function (Salmon, Moraes, Dror and Shaw, "Parallel random numbers: as easy as 1, 2, 3", 2011).
+			Maps a 128 bit `counter` and 64 bit `key` to 128 random bits, as four 32 bit words, with ten rounds of
+			multiply-xor mixing. Distinct counters under one key give independent outputs. */
+		constexpr std::array<std::uint32_t, 4> philox4x32(std::array<std::uint32_t, 4> counter, std::array<std::uint32_t, 2> key)
+		{
+			constexpr std::uint64_t multiplier0 = 0xD2511F53;
+			constexpr std::uint64_t multiplier1 = 0xCD9E8D57;
+			constexpr std::uint32_t weyl0 = 0x9E3779B9;
+			constexpr std::uint32_t weyl1 = 0xBB67AE85;
+			
+			for (int round = 0; round < 10; ++round) {
+				std::uint64_t const product0 = multiplier0 * counter[0];
+				std::uint64_t const product1 = multiplier1 * counter[2];
+				
+				counter = {
+					static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+					static_cast<std::uint32_t>(product1),
+					static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+					static_cast<std::uint32_t>(product0)
+				};
+				key = {key[0] + weyl0, key[1] + weyl1};
+			}
+			
+			return counter;
+		}
+		
+		// Checks whether philox4x32(counter, key) gives `expected`, for the known-answer tests below.
+		constexpr bool philox4x32_gives(std::array<std::uint32_t, 4> counter, std::array<std::uint32_t, 2> key, std::array<std::uint32_t, 4> expected)
+		{
+			std::array<std::uint32_t, 4> const block = philox4x32(counter, key);
+			
+			return block[0] == expected[0] && block[1] == expected[1] && block[2] == expected[2] && block[3] == expected[3];
+		}
+		
+		// Known-answer tests from the Random123 reference implementation.
+		static_assert(philox4x32_gives({0, 0, 0, 0}, {0, 0},
+			{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}), "philox4x32 zero vector");
+		static_assert(philox4x32_gives({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff},
+			{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}), "philox4x32 ones vector");
+		static_assert(philox4x32_gives({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0},
+			{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}), "philox4x32 pi vector");
+		
+		/* Counter-based pseudorandom engine, Philox4x32-10.
+			A generator is addressed by (seed, stream), and the i-th 32 bit number of a stream is word i % 4 of
+			philox4x32({i / 4, stream}, seed), so it can be computed directly by any thread with at or block, without
+			generating the numbers before it. Splitting work across threads by position in one stream, or by stream,
+			therefore gives bit-identical results for any number of threads.
+			Different streams and different seeds give statistically independent sequences. Each stream has 2^66 numbers.
+			Also satisfies UniformRandomBitGenerator, generating a stream sequentially from a position, so it can drive the
+			standard distributions. Copies are independent and cheap. */
+		class philox {
+		public:
+			
+			/* Member type aliases */
+			
+			using result_type = std::uint32_t;
+			using block_type = std::array<result_type, 4>;
+			
+			
+			/* Member constants */
+			
+			// Number of results in each block.
+			static constexpr std::uint64_t block_size = 4;
+			
+			
+			/* Special members */
+			
+			// Constructor from seed and stream, positioned at the first number of the stream.
+			constexpr explicit philox(std::uint64_t seed, std::uint64_t stream = 0) :
+				_key{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)},
+				_stream{stream},
+				_position{0},
+				_buffer{},
+				_buffered{no_block}
+			{}
+			
+			
+			/* Operators */
+			
+			// Function call - gets the number at the current position of the stream and advances the position.
+			constexpr result_type operator()()
+			{
+				std::uint64_t const index = _position / block_size;
+				
+				if (index != _buffered) {
+					_buffer = block(index);
+					_buffered = index;
+				}
+				
+				return _buffer[_position++ % block_size];
+			}
+			
+			
+			/* General member functions */
+			
+			// Gets the smallest number generated.
+			static constexpr result_type min()
+			{
+				return std::numeric_limits<result_type>::min();
+			}
+			
+			// Gets the largest number generated.
+			static constexpr result_type max()
+			{
+				return std::numeric_limits<result_type>::max();
+			}
+			
+			// Gets the `index`-th number of the stream.
+			constexpr result_type at(std::uint64_t index) const
+			{
+				return block(index / block_size)[index % block_size];
+			}
+			
+			// Gets the `index`-th block of block_size numbers of the stream, ie the numbers at [index * block_size, (index + 1) * block_size).
+			constexpr block_type block(std::uint64_t index) const
+			{
+				return philox4x32({
+					static_cast<std::uint32_t>(index),
+					static_cast<std::uint32_t>(index >> 32),
+					static_cast<std::uint32_t>(_stream),
+					static_cast<std::uint32_t>(_stream >> 32)
+				}, _key);
+			}
+			
+			// Advances the position by `count` numbers.
+			constexpr void discard(std::uint64_t count)
+			{
+				_position += count;
+			}
+			
+			// Gets the position, the index of the next number operator() gets.
+			constexpr std::uint64_t position() const
+			{
+				return _position;
+			}
+			
+			// Sets the position, the index of the next number operator() gets.
+			constexpr void seek(std::uint64_t position)
+			{
+				_position = position;
+			}
+			
+			// Gets the stream.
+			constexpr std::uint64_t stream() const
+			{
+				return _stream;
+			}
+			
+			
+		private:
+			
+			/* Member constants */
+			
+			// Value of _buffered when no block is buffered.
+			static constexpr std::uint64_t no_block = std::numeric_limits<std::uint64_t>::max();
+			
+			
+			/* Member variables */
+			
+			// Key, the seed.
+			std::array<std::uint32_t, 2> _key;
+			
+			// Stream, the upper half of the counter.
+			std::uint64_t _stream;
+			
+			// Index of the next number.
+			std::uint64_t _position;
+			
+			// Most recently generated block.
+			block_type _buffer;
+			
+			// Index of the block in _buffer.
+			std::uint64_t _buffered;
+		};
+		
+		
+		/* Bulk fills.
+			fill_uniform, fill_normal and fill_bernoulli fill a whole matrix, vector or array from a philox generator.
+			Element i (in storage order, ie row by row for a row major matrix) is made from block first + i / k of the
+			generator's stream, where first is the block at the generator's position and k the number of elements made from
+			one block, and the generator is then advanced past the blocks used. So the values depend only on the generator and
+			the shape, never on how the work is split: large fills are spread across the tc::parallel thread pool and give
+			bit-identical results for any number of threads. */
+		
+		/* Uniform value in [0, 1) from the top bits of a block word (float) or a pair of words (double).
+			Every value is a multiple of 2^-24 (float) or 2^-53 (double). */
+		template<typename T>
+		inline T unit_uniform(std::uint32_t low, std::uint32_t high)
+		{
+			if constexpr (std::is_same_v<T, float>) {
+				return static_cast<float>(high >> 8) * 0x1p-24f;
+			}
+			else {
+				return static_cast<double>(((std::uint64_t{high} << 32) | low) >> 11) * 0x1p-53;
+			}
+		}
+		
+		// Coefficients c[i] = (-1)^i / (2i + 1)!, the Taylor series of sin(x) / x in x^2.
+		template<typename T>
+		constexpr std::array<T, std::is_same_v<T, float> ? 5 : 8> sin_coefficients = []() {
+			std::array<T, std::is_same_v<T, float> ? 5 : 8> c{};
+			double term = 1;
+			
+			for (std::size_t i = 0; i < c.size(); ++i) {
+				c[i] = static_cast<T>(term);
+				term /= -static_cast<double>((2 * i + 2) * (2 * i + 3));
+			}
+			return c;
+		}();
+		
+		// Coefficients c[i] = (-1)^i / (2i)!, the Taylor series of cos(x) in x^2.
+		template<typename T>
+		constexpr std::array<T, std::is_same_v<T, float> ? 6 : 9> cos_coefficients = []() {
+			std::array<T, std::is_same_v<T, float> ? 6 : 9> c{};
+			double term = 1;
+			
+			for (std::size_t i = 0; i < c.size(); ++i) {
+				c[i] = static_cast<T>(term);
+				term /= -static_cast<double>((2 * i + 1) * (2 * i + 2));
+			}
+			return c;
+		}();
+		
+		/* Sine and cosine of 2 pi `turns` for 0 <= turns <= 1, branchless so loops over it are vectorised.
+			The angle is reduced to the nearest quarter turn, leaving |x| <= pi / 4 for the series. */
+		template<typename T>
+		inline void sin_cos_turns(T turns, T& sin, T& cos)
+		{
+			T const quarters = tc::math_f::round(turns * T{4});
+			T const x = (turns * T{4} - quarters) * T{1.57079632679489661923};
+			T const w = x * x;
+			T const s = x * tc::math_f::polynomial(w, sin_coefficients<T>);
+			T const c = tc::math_f::polynomial(w, cos_coefficients<T>);
+			unsigned const quadrant = static_cast<unsigned>(quarters) & 3u;
+			
+			// Rotating by a quarter turn swaps sine and cosine and negates the new cosine.
+			T const sin_q = quadrant & 1u ? c : s;
+			T const cos_q = quadrant & 1u ? -s : c;
+			
+			sin = quadrant & 2u ? -sin_q : sin_q;
+			cos = quadrant & 2u ? -cos_q : cos_q;
+		}
+		
+		/* Square root of a finite `x` >= 0, within a few ulp.
+			Computed by Newton iteration on the reciprocal square root from a bit-level estimate: std::sqrt may set errno,
+			and the check for that stops loops calling it from being vectorised. */
+		template<typename T>
+		inline T sqrt_nonnegative(T x)
+		{
+			using traits = tc::math_f::float_traits<T>;
+			
+			constexpr typename traits::bits_type magic = std::is_same_v<T, float> ? 0x5F3759DFu : 0x5FE6EB50C7B537A9u;
+			
+			// Each step squares the relative error, three reach float precision and a fourth double precision.
+			// Multiplied left to right so that x = 0 gives 0 rather than 0 * infinity.
+			auto const step = [x](T r) { return r * (T{1.5} - T{0.5} * x * r * r); };
+			
+			T r = step(step(step(tc::math_f::from_bits<T>(magic - (tc::math_f::to_bits(x) >> 1)))));
+			
+			if constexpr (!std::is_same_v<T, float>) {
+				r = step(r);
+			}
+			return x * r;
+		}
+		
+		/* Fills out[0, n) with elements [first, first + n) of a sequence made from the blocks of `generator`'s stream from
+			block `base`, kernel(block, values) making the PerBlock elements of one block.
+			A group of blocks is made at a time into local arrays so that the kernel loop is vectorised. */
+		template<std::size_t PerBlock, typename T, typename Kernel>
+		void generate(philox const& generator, std::uint64_t base, std::uint64_t first, std::size_t n, T* out, Kernel kernel)
+		{
+			constexpr std::size_t group = 8;
+			
+			std::uint64_t const last = first + n;
+			
+			for (std::uint64_t index = first; index < last;) {
+				std::uint64_t const block = index / PerBlock;
+				std::uint64_t const begin = block * PerBlock;
+				std::uint64_t const end = std::min<std::uint64_t>(begin + group * PerBlock, last);
+				philox::block_type words[group];
+				T values[group * PerBlock];
+				
+				for (std::size_t j = 0; j < group; ++j) {
+					words[j] = generator.block(base + block + j);
+				}
+				for (std::size_t j = 0; j < group; ++j) {
+					kernel(words[j], values + j * PerBlock);
+				}
+				
+				std::copy_n(values + (index - begin), end - index, out + (index - first));
+				index = end;
+			}
+		}
+		
+		// std::true_type if T has rows() (is a matrix), otherwise std::false_type.
+		template<class T, typename = void>
+		struct has_rows : std::false_type {};
+		
+		// std::true_type if T has rows() (is a matrix), otherwise std::false_type.
+		template<class T>
+		struct has_rows<T, std::void_t<decltype(std::declval<T const&>().rows())>> : std::true_type {};
+		
+		/* Fills `result` (a matrix_view, vector_view or anything with the same interface) with the sequence made by
+			kernel from `generator`'s stream as described for the bulk fills, and advances `generator` past it.
+			Contiguous ranges are split into chunks of tc::parallel::chunk_size elements, non-contiguous matrices into lines,
+			strided vectors are generated per chunk into scratch space and scattered. */
+		template<std::size_t PerBlock, class Output, typename Kernel>
+		void fill_with(Output& result, philox& generator, Kernel kernel)
+		{
+			using value_type = typename Output::value_type;
+			
+			std::uint64_t const base = (generator.position() + philox::block_size - 1) / philox::block_size;
+			std::size_t const n = result.size();
+			auto const data = result.data();
+			
+			auto const contiguous = [&](std::size_t begin, std::size_t end) {
+				generate<PerBlock>(generator, base, begin, end - begin, data + begin, kernel);
+			};
+			
+			if (result.is_contiguous()) {
+				tc::parallel::for_each_chunk(n, contiguous);
+			}
+			else if constexpr (has_rows<Output>::value) {
+				std::size_t const lines = Output::is_row_major ? result.rows() : result.columns();
+				std::size_t const length = n / std::max<std::size_t>(lines, 1);
+				std::size_t const stride = result.stride();
+				
+				tc::parallel::for_each_chunk(lines, [&](std::size_t begin, std::size_t end) {
+					for (std::size_t line = begin; line < end; ++line) {
+						generate<PerBlock>(generator, base, line * length, length, data + line * stride, kernel);
+					}
+				}, std::max<std::size_t>(tc::parallel::chunk_size / std::max<std::size_t>(length, 1), 1));
+			}
+			else {
+				std::size_t const stride = result.stride();
+				
+				tc::parallel::for_each_chunk(n, [&](std::size_t begin, std::size_t end) {
+					tc::workspace::scope scratch;
+					value_type* const values = scratch.allocate<value_type>(end - begin);
+					
+					generate<PerBlock>(generator, base, begin, end - begin, values, kernel);
+					for (std::size_t i = begin; i < end; ++i) {
+						data[i * stride] = values[i - begin];
+					}
+				});
+			}
+			
+			generator.seek((base + (n + PerBlock - 1) / PerBlock) * philox::block_size);
+		}
+		
+		/* Fills `result` (a matrix_view, vector_view, or any matrix or vector with the same interface) with floating point
+			values uniformly distributed in [low, high), and advances `generator` past the numbers used.
+			Two values are made from each block for double, four for float. */
+		template<class Output>
+		void fill_uniform(Output& result, typename Output::value_type low, typename Output::value_type high, philox& generator)
+		{
+			using value_type = typename Output::value_type;
+			
+			static_assert(std::is_floating_point_v<value_type>, "fill_uniform fills floating point values");
+			
+			value_type const scale = high - low;
+			
+			if constexpr (std::is_same_v<value_type, float>) {
+				fill_with<4>(result, generator, [=](philox::block_type const& block, float* values) {
+					for (std::size_t i = 0; i < 4; ++i) {
+						values[i] = low + scale * unit_uniform<float>(0, block[i]);
+					}
+				});
+			}
+			else {
+				fill_with<2>(result, generator, [=](philox::block_type const& block, value_type* values) {
+					values[0] = low + scale * static_cast<value_type>(unit_uniform<double>(block[0], block[1]));
+					values[1] = low + scale * static_cast<value_type>(unit_uniform<double>(block[2], block[3]));
+				});
+			}
+		}
+		
+		/* Fills the `size` elements from `data` with floating point values uniformly distributed in [low, high), and
+			advances `generator` past the numbers used. */
+		template<typename T>
+		void fill_uniform(T* data, std::size_t size, T low, T high, philox& generator)
+		{
+			tc::vector_view::vector_view<T> view{data, size};
+			
+			fill_uniform(view, low, high, generator);
+		}
+		
+		/* Fills `result` (a matrix_view, vector_view, or any matrix or vector with the same interface) with normally
+			distributed floating point values of the given mean and standard deviation, and advances `generator` past the
+			numbers used.
+			Uses the Box-Muller transform, both values of each pair are used: two values per block for double, four for
+			float. The transform is branchless, so it is vectorised. Float values come from 24 bit uniforms, which bounds
+			them to within 5.8 standard deviations of the mean. */
+		template<class Output>
+		void fill_normal(Output& result, typename Output::value_type mean, typename Output::value_type deviation, philox& generator)
+		{
+			using value_type = typename Output::value_type;
+			
+			static_assert(std::is_floating_point_v<value_type>, "fill_normal fills floating point values");
+			
+			// Box-Muller transform of u1 in (0, 1] and u2 in [0, 1).
+			auto const transform = [=](value_type u1, value_type u2, value_type* values) {
+				value_type const radius = deviation * sqrt_nonnegative(value_type{-2} * tc::math_f::log(u1));
+				value_type sin;
+				value_type cos;
+				
+				sin_cos_turns(u2, sin, cos);
+				values[0] = mean + radius * cos;
+				values[1] = mean + radius * sin;
+			};
+			
+			if constexpr (std::is_same_v<value_type, float>) {
+				fill_with<4>(result, generator, [=](philox::block_type const& block, float* values) {
+					transform(1.0f - unit_uniform<float>(0, block[0]), unit_uniform<float>(0, block[1]), values);
+					transform(1.0f - unit_uniform<float>(0, block[2]), unit_uniform<float>(0, block[3]), values + 2);
+				});
+			}
+			else {
+				fill_with<2>(result, generator, [=](philox::block_type const& block, value_type* values) {
+					transform(value_type{1} - unit_uniform<double>(block[0], block[1]), unit_uniform<double>(block[2], block[3]), values);
+				});
+			}
+		}
+		
+		/* Fills the `size` elements from `data` with normally distributed floating point values of the given mean and
+			standard deviation, and advances `generator` past the numbers used. */
+		template<typename T>
+		void fill_normal(T* data, std::size_t size, T mean, T deviation, philox& generator)
+		{
+			tc::vector_view::vector_view<T> view{data, size};
+			
+			fill_normal(view, mean, deviation, generator);
+		}
+		
+		/* Fills `result` (a matrix_view, vector_view, or any matrix or vector with the same interface) with ones with
+			probability `probability` and zeros otherwise, and advances `generator` past the numbers used.
+			Four values are made from each block, each by comparing a 32 bit number against probability * 2^32. */
+		template<class Output>
+		void fill_bernoulli(Output& result, double probability, philox& generator)
+		{
+			using value_type = typename Output::value_type;
+			
+			#ifdef _DEBUG
+				assert(probability >= 0.0 && probability <= 1.0);
+			#endif
+			
+			std::uint64_t const threshold = static_cast<std::uint64_t>(probability * 0x1p32);
+			
+			fill_with<4>(result, generator, [=](philox::block_type const& block, value_type* values) {
+				for (std::size_t i = 0; i < 4; ++i) {
+					values[i] = block[i] < threshold ? value_type{1} : value_type{};
+				}
+			});
+		}
+		
+		/* Fills the `size` elements from `data` with ones with probability `probability` and zeros otherwise, and advances
+			`generator` past the numbers used. */
+		template<typename T>
+		void fill_bernoulli(T* data, std::size_t size, double probability, philox& generator)
+		{
+			tc::vector_view::vector_view<T> view{data, size};
+			
+			fill_bernoulli(view, probability, generator);
+		}
+		
 	}
 }
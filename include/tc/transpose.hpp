@@ -0,0 +1,222 @@
+#pragma once
+
+#include <algorithm>		// std::copy_n, std::max, std::min, std::swap
+#include <cstddef>			// std::size_t, std::ptrdiff_t
+#include <type_traits>		// std::is_same_v
+#if defined(__AVX__)
+	#include <immintrin.h>	// __m256, __m256d, _mm256_*
+#endif
+#include "parallel.hpp"		// tc::parallel::for_each_chunk, tc::parallel::for_each_task, tc::parallel::chunk_size
+
+
+namespace tc {
+	namespace transpose {
+
+		// Side of the micro tile transposed in registers.
+		template<typename T>
+		constexpr inline std::size_t tile = sizeof(T) >= 8 ? 4 : 8;
+
+		// Side of the cache block made of micro tiles, a source and destination block together fit in L1.
+		constexpr inline std::size_t block = 64;
+
+		/* Transposes one tile x tile micro tile, dst(j, i) = src(i, j).
+			Uses an in-register unpack/permute network for float and double on AVX targets. */
+		template<typename T>
+		inline void transpose_tile(T const* src, std::ptrdiff_t lds, T* dst, std::ptrdiff_t ldd)
+		{
+			#if defined(__AVX__)
+				if constexpr (std::is_same_v<T, double>) {
+					__m256d const r0 = _mm256_loadu_pd(src);
+					__m256d const r1 = _mm256_loadu_pd(src + lds);
+					__m256d const r2 = _mm256_loadu_pd(src + 2 * lds);
+					__m256d const r3 = _mm256_loadu_pd(src + 3 * lds);
+
+					__m256d const t0 = _mm256_unpacklo_pd(r0, r1);
+					__m256d const t1 = _mm256_unpackhi_pd(r0, r1);
+					__m256d const t2 = _mm256_unpacklo_pd(r2, r3);
+					__m256d const t3 = _mm256_unpackhi_pd(r2, r3);
+
+					_mm256_storeu_pd(dst, _mm256_permute2f128_pd(t0, t2, 0x20));
+					_mm256_storeu_pd(dst + ldd, _mm256_permute2f128_pd(t1, t3, 0x20));
+					_mm256_storeu_pd(dst + 2 * ldd, _mm256_permute2f128_pd(t0, t2, 0x31));
+					_mm256_storeu_pd(dst + 3 * ldd, _mm256_permute2f128_pd(t1, t3, 0x31));
+					return;
+				}
+				else if constexpr (std::is_same_v<T, float>) {
+					__m256 r[8];
+					for (std::size_t i = 0; i < 8; ++i) {
+						r[i] = _mm256_loadu_ps(src + static_cast<std::ptrdiff_t>(i) * lds);
+					}
+
+					__m256 t[8];
+					for (std::size_t i = 0; i < 8; i += 2) {
+						t[i] = _mm256_unpacklo_ps(r[i], r[i + 1]);
+						t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+					}
+
+					__m256 u[8];
+					for (std::size_t i = 0; i < 8; i += 4) {
+						u[i] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+						u[i + 1] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+						u[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+						u[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+					}
+
+					for (std::size_t i = 0; i < 4; ++i) {
+						_mm256_storeu_ps(dst + static_cast<std::ptrdiff_t>(i) * ldd, _mm256_permute2f128_ps(u[i], u[i + 4], 0x20));
+						_mm256_storeu_ps(dst + static_cast<std::ptrdiff_t>(i + 4) * ldd, _mm256_permute2f128_ps(u[i], u[i + 4], 0x31));
+					}
+					return;
+				}
+			#endif
+
+			constexpr std::size_t n = tile<T>;
+			T t[n][n];
+
+			for (std::size_t i = 0; i < n; ++i) {
+				for (std::size_t j = 0; j < n; ++j) {
+					t[j][i] = src[static_cast<std::ptrdiff_t>(i) * lds + static_cast<std::ptrdiff_t>(j)];
+				}
+			}
+			for (std::size_t j = 0; j < n; ++j) {
+				for (std::size_t i = 0; i < n; ++i) {
+					dst[static_cast<std::ptrdiff_t>(j) * ldd + static_cast<std::ptrdiff_t>(i)] = t[j][i];
+				}
+			}
+		}
+
+		/* Transposes an m x n region, dst(j, i) = src(i, j), tile by tile.
+			Rows and columns left over from whole micro tiles are transposed element by element. */
+		template<typename T>
+		void transpose_block(std::size_t m, std::size_t n, T const* src, std::ptrdiff_t lds, T* dst, std::ptrdiff_t ldd)
+		{
+			constexpr std::size_t t = tile<T>;
+
+			std::size_t const mt = m / t * t;
+			std::size_t const nt = n / t * t;
+
+			for (std::size_t i = 0; i < mt; i += t) {
+				for (std::size_t j = 0; j < nt; j += t) {
+					transpose_tile<T>(src + static_cast<std::ptrdiff_t>(i) * lds + static_cast<std::ptrdiff_t>(j), lds,
+						dst + static_cast<std::ptrdiff_t>(j) * ldd + static_cast<std::ptrdiff_t>(i), ldd);
+				}
+			}
+
+			for (std::size_t i = 0; i < m; ++i) {
+				for (std::size_t j = (i < mt ? nt : 0); j < n; ++j) {
+					dst[static_cast<std::ptrdiff_t>(j) * ldd + static_cast<std::ptrdiff_t>(i)] = src[static_cast<std::ptrdiff_t>(i) * lds + static_cast<std::ptrdiff_t>(j)];
+				}
+			}
+		}
+
+		/* Out-of-place transposition of an m x n matrix into an n x m matrix, dst(j, i) = src(i, j).
+			Rows of each matrix are `lds` and `ldd` elements apart. The matrix is cut into cache blocks which are split
+			across threads, each block is transposed micro tile by micro tile.
+			`src` and `dst` must not overlap. */
+		template<typename T>
+		void transpose(std::size_t m, std::size_t n, T const* src, std::ptrdiff_t lds, T* dst, std::ptrdiff_t ldd)
+		{
+			std::size_t const block_rows = (m + block - 1) / block;
+			std::size_t const block_columns = (n + block - 1) / block;
+
+			tc::parallel::for_each_task(block_rows * block_columns, [&](std::size_t task) {
+				std::size_t const i = (task / block_columns) * block;
+				std::size_t const j = (task % block_columns) * block;
+
+				transpose_block<T>(std::min(block, m - i), std::min(block, n - j),
+					src + static_cast<std::ptrdiff_t>(i) * lds + static_cast<std::ptrdiff_t>(j), lds,
+					dst + static_cast<std::ptrdiff_t>(j) * ldd + static_cast<std::ptrdiff_t>(i), ldd);
+			});
+		}
+
+		/* Copies an m x n matrix, dst(i, j) = src(i, j), between any combination of storage orders.
+			Element (i, j) of each matrix is at i * rs + j * cs, `rs` and `cs` being its row and column strides.
+			Matching orders are copied line by line across threads, differing orders use the blocked transpose,
+			anything else (neither stride 1) is copied element by element.
+			`src` and `dst` must not overlap. */
+		template<typename T>
+		void copy(std::size_t m, std::size_t n, T const* src, std::ptrdiff_t rss, std::ptrdiff_t css, T* dst, std::ptrdiff_t rsd, std::ptrdiff_t csd)
+		{
+			// Copies `lines` lines of `length` contiguous elements, lines `lss` and `lsd` elements apart.
+			auto const copy_lines = [=](std::size_t lines, std::size_t length, std::ptrdiff_t lss, std::ptrdiff_t lsd) {
+				std::size_t const lines_per_chunk = std::max<std::size_t>(tc::parallel::chunk_size / std::max<std::size_t>(length, 1), 1);
+
+				tc::parallel::for_each_chunk(lines, [=](std::size_t begin, std::size_t end) {
+					for (std::size_t l = begin; l < end; ++l) {
+						std::copy_n(src + static_cast<std::ptrdiff_t>(l) * lss, length, dst + static_cast<std::ptrdiff_t>(l) * lsd);
+					}
+				}, lines_per_chunk);
+			};
+
+			if (css == 1 && csd == 1) {
+				copy_lines(m, n, rss, rsd);
+			}
+			else if (rss == 1 && rsd == 1) {
+				copy_lines(n, m, css, csd);
+			}
+			else if (css == 1 && rsd == 1) {
+				transpose<T>(m, n, src, rss, dst, csd);
+			}
+			else if (rss == 1 && csd == 1) {
+				transpose<T>(n, m, src, css, dst, rsd);
+			}
+			else {
+				for (std::size_t i = 0; i < m; ++i) {
+					for (std::size_t j = 0; j < n; ++j) {
+						dst[static_cast<std::ptrdiff_t>(i) * rsd + static_cast<std::ptrdiff_t>(j) * csd] = src[static_cast<std::ptrdiff_t>(i) * rss + static_cast<std::ptrdiff_t>(j) * css];
+					}
+				}
+			}
+		}
+
+		/* In-place transposition of an n x n matrix with rows `lda` elements apart.
+			Each task takes one block row of the upper triangle and swaps its blocks with their mirror images below the diagonal,
+			micro tiles are exchanged through a small L1 resident buffer. */
+		template<typename T>
+		void transpose_square(std::size_t n, T* a, std::ptrdiff_t lda)
+		{
+			constexpr std::size_t t = tile<T>;
+
+			std::size_t const blocks = (n + block - 1) / block;
+
+			auto const at = [=](std::size_t i, std::size_t j) {
+				return a + static_cast<std::ptrdiff_t>(i) * lda + static_cast<std::ptrdiff_t>(j);
+			};
+
+			tc::parallel::for_each_task(blocks, [&](std::size_t bi) {
+				std::size_t const i_begin = bi * block;
+				std::size_t const i_end = std::min(i_begin + block, n);
+				T buffer[t * t];
+
+				for (std::size_t bj = bi; bj < blocks; ++bj) {
+					std::size_t const j_end = std::min((bj + 1) * block, n);
+
+					for (std::size_t i = i_begin; i < i_end; i += t) {
+						for (std::size_t j = std::max(bj * block, i); j < j_end; j += t) {
+							if (i + t <= n && j + t <= n) {
+								// Keep the upper tile, move the transposed lower tile up, then write the kept tile down transposed.
+								for (std::size_t r = 0; r < t; ++r) {
+									std::copy_n(at(i + r, j), t, buffer + r * t);
+								}
+
+								if (i != j) {
+									transpose_tile<T>(at(j, i), lda, at(i, j), lda);
+								}
+
+								transpose_tile<T>(buffer, static_cast<std::ptrdiff_t>(t), at(j, i), lda);
+							}
+							else {
+								for (std::size_t ii = i; ii < std::min(i + t, n); ++ii) {
+									for (std::size_t jj = std::max(j, ii + 1); jj < std::min(j + t, n); ++jj) {
+										std::swap(*at(ii, jj), *at(jj, ii));
+									}
+								}
+							}
+						}
+					}
+				}
+			});
+		}
+
+	}
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#ifdef _DEBUG
+	#include <cassert>			// assert
+#endif
+#include <cstddef>				// std::size_t
+#include <memory>				// std::pointer_traits
+#include <type_traits>			// std::remove_cv_t
+#include <utility>				// std::exchange, std::move
+#include "aligned.hpp"			// tc::aligned::alignment, tc::aligned::allocate, tc::aligned::unique_array
+#include "vector_view.hpp"		// tc::vector_view::vector_view
+
+
+namespace tc {
+	namespace vector {
+
+		/* Owning vector, elements stored contiguously in an array aligned to tc::aligned::alignment bytes.
+			Elements are zeroed on construction. The alignment is part of the type, as the member constant `alignment`
+			(see tc::aligned::alignment_of).
+			Move-only. Converts implicitly to a vector_view of its elements (through vector_view's container constructor),
+			and has the same interface as vector_view, so it can be passed to the vector operations directly.
+			Element access is 1-indexed. */
+		template<typename T>
+		class vector {
+		public:
+
+			/* Member type aliases */
+
+			using element_type = T;
+			using value_type = std::remove_cv_t<element_type>;
+			using size_type = std::size_t;
+			using reference = element_type&;
+			using const_reference = element_type const&;
+			using pointer = element_type*;
+			using const_pointer = element_type const*;
+			using difference_type = typename std::pointer_traits<pointer>::difference_type;
+
+			// View of the elements.
+			using view_type = tc::vector_view::vector_view<element_type>;
+
+			// Read-only view of the elements.
+			using const_view_type = tc::vector_view::vector_view<element_type const>;
+
+
+			/* Member constants */
+
+			// Alignment of the first element in bytes.
+			static constexpr std::size_t alignment = tc::aligned::alignment;
+
+
+			/* Special members */
+
+			// Destructor.
+			~vector() = default;
+
+			// Default constructor, an empty vector.
+			vector() :
+				_data{},
+				_size{0}
+			{}
+
+			// Copy constructor - deleted, vectors are move-only.
+			vector(vector const&) = delete;
+
+			// Move constructor, `other` is left empty.
+			vector(vector&& other) noexcept :
+				_data{std::move(other._data)},
+				_size{std::exchange(other._size, 0)}
+			{}
+
+			// Constructor from size, elements are zeroed.
+			explicit vector(size_type size) :
+				_data{tc::aligned::allocate<value_type>(size)},
+				_size{size}
+			{}
+
+
+			/* Operators */
+
+			// Simple assignment - copy - deleted, vectors are move-only.
+			vector& operator=(vector const&) = delete;
+
+			// Simple assignment - move, `other` is left empty.
+			vector& operator=(vector&& other) noexcept
+			{
+				_data = std::move(other._data);
+				_size = std::exchange(other._size, 0);
+				return *this;
+			}
+
+			/* Function call - element access.
+				Bounds checked for debug builds. */
+			reference operator()(size_type index)
+			{
+				#ifdef _DEBUG
+					assert(index > 0 && index <= _size);
+				#endif
+
+				return _data[index - 1];
+			}
+
+			/* Function call - element access.
+				Bounds checked for debug builds. */
+			const_reference operator()(size_type index) const
+			{
+				#ifdef _DEBUG
+					assert(index > 0 && index <= _size);
+				#endif
+
+				return _data[index - 1];
+			}
+
+
+			/* General member functions */
+
+			// Gets the pointer to the start of the array.
+			pointer data()
+			{
+				return _data.get();
+			}
+
+			// Gets the pointer to the start of the array.
+			const_pointer data() const
+			{
+				return _data.get();
+			}
+
+			// Checks whether the elements are contiguous, always true.
+			bool is_contiguous() const
+			{
+				return true;
+			}
+
+			// Gets the number of elements.
+			size_type size() const
+			{
+				return _size;
+			}
+
+			// Gets the number of elements between consecutive elements, always 1.
+			size_type stride() const
+			{
+				return 1;
+			}
+
+			// Gets a view of the elements.
+			view_type view()
+			{
+				return {_data.get(), _size};
+			}
+
+			// Gets a read-only view of the elements.
+			const_view_type view() const
+			{
+				return {_data.get(), _size};
+			}
+
+
+		private:
+
+			/* Member variables */
+
+			// Owned, aligned array of elements.
+			tc::aligned::unique_array<value_type> _data;
+
+			// Number of elements.
+			size_type _size;
+		};
+
+	}
+}
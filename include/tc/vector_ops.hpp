@@ -3,7 +3,7 @@
 #ifdef _DEBUG
 	#include <cassert>		// assert
 #endif
-#include <cmath>			// std::abs, std::pow
+#include <cmath>			// std::abs, std::pow, std::sqrt
 #include <cstddef>			// std::size_t
 
 
@@ -12,7 +12,7 @@ namespace tc {
 
 		// Scalar-vector elementwise multiplication.
 		template<typename SizeType = std::size_t, typename Element, class InputVector, class OutputVector>
-		void sv_mul(Element const& lhs, InputVector& rhs, OutputVector& result)
+		void sv_mul(Element const& lhs, InputVector const& rhs, OutputVector& result)
 		{
 			#ifdef _DEBUG
 				assert(rhs.size() == result.size());
@@ -43,7 +43,21 @@ namespace tc {
 			result = Element{};
 
 			for (SizeType i = 1; i <= in.size(); ++i) {
-				result; += in(i);
+				result += in(i);
+			}
+		}
+
+		/* Evaluates a vector expression into a vector, in one pass over the elements.
+			`result` may appear in the expression, each element only reads the same element of its operands. */
+		template<typename SizeType = std::size_t, class Expression, class OutputVector>
+		void v_eval(Expression const& expression, OutputVector& result)
+		{
+			#ifdef _DEBUG
+				assert(expression.size() == result.size());
+			#endif
+
+			for (SizeType i = 1; i <= result.size(); ++i) {
+				result(i) = expression(i);
 			}
 		}
 
@@ -77,7 +91,7 @@ namespace tc {
 
 			for (SizeType i = 1; i <= in.size(); ++i) {
 				auto a = std::abs(in(i));
-				result; += a * a;
+				result += a * a;
 			}
 
 			result = std::sqrt(result);
@@ -168,8 +182,8 @@ namespace tc {
 		}
 
 		// Vector-vector matrix product (column vector by row vector).
-		template<typename SizeType = std::size_t, class InputVector, class OutputMatrix>
-		void vv_mprod(InputVector const& lhs, InputVector const& rhs, OutputMatrix& result)
+		template<typename SizeType = std::size_t, class InputVector1, class InputVector2, class OutputMatrix>
+		void vv_mprod(InputVector1 const& lhs, InputVector2 const& rhs, OutputMatrix& result)
 		{
 			#ifdef _DEBUG
 				assert(lhs.size() == result.rows());
@@ -183,6 +197,26 @@ namespace tc {
 			}
 		}
 
+		/* Vector-vector matrix product (column vector by row vector), result = alpha lhs rhs^T + beta result.
+			With `beta` one this is the rank-1 update (ger), accumulating the product into `result` in place.
+			`result` is not read when `beta` is zero. */
+		template<typename SizeType = std::size_t, typename Element1, class InputVector1, class InputVector2, typename Element2, class OutputMatrix>
+		void vv_mprod(Element1 const& alpha, InputVector1 const& lhs, InputVector2 const& rhs, Element2 const& beta, OutputMatrix& result)
+		{
+			#ifdef _DEBUG
+				assert(lhs.size() == result.rows());
+				assert(rhs.size() == result.columns());
+			#endif
+
+			for (SizeType i = 1; i <= lhs.size(); ++i) {
+				auto const a = alpha * lhs(i);
+
+				for (SizeType j = 1; j <= rhs.size(); ++j) {
+					result(i, j) = beta == Element2{} ? a * rhs(j) : a * rhs(j) + beta * result(i, j);
+				}
+			}
+		}
+
 		// Vector-vector elementwise subtraction.
 		template<typename SizeType = std::size_t, class InputVector1, class InputVector2, class OutputVector>
 		void vv_sub(InputVector1 const& lhs, InputVector2 const& rhs, OutputVector& result)
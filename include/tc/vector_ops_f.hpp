@@ -1,10 +1,405 @@
 #pragma once
 
+#include <algorithm>		// std::max
+#ifdef _DEBUG
+	#include <cassert>		// assert
+#endif
+#include <cmath>			// std::abs, std::pow, std::sqrt
+#include <cstddef>			// std::size_t
+#include <type_traits>		// std::is_same_v
+#include "math_f.hpp"		// tc::math_f::find_batch, tc::math_f::has_batch
+#include "matrix_view.hpp"	// tc::matrix_view::is_column_major_v
+#include "parallel.hpp"		// tc::parallel::for_each_chunk, tc::parallel::sum, tc::parallel::chunk_size
+#include "vector_ops.hpp"	// tc::vector_ops
+
 
 namespace tc {
 	namespace vector_ops_f {
-		
-		
-		
+
+		// Each operation falls back to its tc::vector_ops counterpart if a vector is not contiguous.
+
+		// Scalar-vector elementwise multiplication.
+		template<typename SizeType = std::size_t, typename Element, class InputVector, class OutputVector>
+		void sv_mul(Element const& lhs, InputVector const& rhs, OutputVector& result)
+		{
+			#ifdef _DEBUG
+				assert(rhs.size() == result.size());
+			#endif
+
+			if (!rhs.is_contiguous() || !result.is_contiguous()) {
+				tc::vector_ops::sv_mul<SizeType>(lhs, rhs, result);
+				return;
+			}
+
+			auto const in = rhs.data();
+			auto const out = result.data();
+
+			tc::parallel::for_each_chunk(rhs.size(), [=](std::size_t begin, std::size_t end) {
+				for (std::size_t i = begin; i < end; ++i) {
+					out[i] = lhs * in[i];
+				}
+			});
+		}
+
+		// Vector elementwise copy.
+		template<typename SizeType = std::size_t, class InputVector, class OutputVector>
+		void v_cpy(InputVector const& in, OutputVector& out)
+		{
+			#ifdef _DEBUG
+				assert(in.size() == out.size());
+			#endif
+
+			if (!in.is_contiguous() || !out.is_contiguous()) {
+				tc::vector_ops::v_cpy<SizeType>(in, out);
+				return;
+			}
+
+			auto const src = in.data();
+			auto const dst = out.data();
+
+			tc::parallel::for_each_chunk(in.size(), [=](std::size_t begin, std::size_t end) {
+				for (std::size_t i = begin; i < end; ++i) {
+					dst[i] = src[i];
+				}
+			});
+		}
+
+		// Vector element sum.
+		template<typename SizeType = std::size_t, class InputVector, typename Element>
+		void v_esum(InputVector const& in, Element& result)
+		{
+			if (!in.is_contiguous()) {
+				tc::vector_ops::v_esum<SizeType>(in, result);
+				return;
+			}
+
+			auto const src = in.data();
+
+			result = tc::parallel::sum<Element>(in.size(), [=](std::size_t i) {
+				return static_cast<Element>(src[i]);
+			});
+		}
+
+		/* Evaluates a vector expression into a vector, in one pass over the elements, chunks split across threads.
+			`result` may appear in the expression, each element only reads the same element of its operands. */
+		template<typename SizeType = std::size_t, class Expression, class OutputVector>
+		void v_eval(Expression const& expression, OutputVector& result)
+		{
+			#ifdef _DEBUG
+				assert(expression.size() == result.size());
+			#endif
+
+			tc::parallel::for_each_chunk(result.size(), [&](std::size_t begin, std::size_t end) {
+				for (SizeType i = begin + 1; i <= end; ++i) {
+					result(i) = expression(i);
+				}
+			});
+		}
+
+		// Sets all vector elements to a value.
+		template<typename SizeType = std::size_t, class OutputVector, typename Element>
+		void v_fill(OutputVector& vector, Element const& value)
+		{
+			if (!vector.is_contiguous()) {
+				tc::vector_ops::v_fill<SizeType>(vector, value);
+				return;
+			}
+
+			auto const dst = vector.data();
+
+			tc::parallel::for_each_chunk(vector.size(), [=](std::size_t begin, std::size_t end) {
+				for (std::size_t i = begin; i < end; ++i) {
+					dst[i] = value;
+				}
+			});
+		}
+
+		/* Transforms each vector element with a function.
+			The vectorised batch kernels of tc::math_f are used when `function` is one of the elementwise functions of
+			tc::math_f (or of tc::math when compiling for AVX2, see tc::math_f::replaces_math), or has a `batch(in, n, out)`
+			member, and the vectors share a value type. */
+		template<typename SizeType = std::size_t, class InputVector, typename Function, class OutputVector>
+		void v_fn(InputVector const& in, Function function, OutputVector& result)
+		{
+			#ifdef _DEBUG
+				assert(in.size() == result.size());
+			#endif
+
+			if (!in.is_contiguous() || !result.is_contiguous()) {
+				tc::vector_ops::v_fn<SizeType>(in, function, result);
+				return;
+			}
+
+			using value_type = typename OutputVector::value_type;
+
+			auto const src = in.data();
+			auto const dst = result.data();
+
+			if constexpr (std::is_same_v<typename InputVector::value_type, value_type>) {
+				if constexpr (tc::math_f::has_batch<Function, value_type>::value) {
+					tc::parallel::for_each_chunk(in.size(), [&](std::size_t begin, std::size_t end) {
+						function.batch(src + begin, end - begin, dst + begin);
+					});
+					return;
+				}
+				else if (auto const batch = tc::math_f::find_batch<value_type>(function)) {
+					tc::parallel::for_each_chunk(in.size(), [=](std::size_t begin, std::size_t end) {
+						batch(src + begin, end - begin, dst + begin);
+					});
+					return;
+				}
+			}
+
+			tc::parallel::for_each_chunk(in.size(), [=](std::size_t begin, std::size_t end) {
+				for (std::size_t i = begin; i < end; ++i) {
+					dst[i] = function(src[i]);
+				}
+			});
+		}
+
+		// Vector L^2 (Euclidean) norm.
+		template<typename SizeType = std::size_t, class InputVector, typename Element>
+		void v_l2norm(InputVector const& in, Element& result)
+		{
+			if (!in.is_contiguous()) {
+				tc::vector_ops::v_l2norm<SizeType>(in, result);
+				return;
+			}
+
+			auto const src = in.data();
+
+			result = std::sqrt(tc::parallel::sum<Element>(in.size(), [=](std::size_t i) {
+				Element const a = std::abs(src[i]);
+				return a * a;
+			}));
+		}
+
+		// Vector p-norm.
+		template<typename SizeType = std::size_t, class InputVector, typename Value, typename Element>
+		void v_pnorm(InputVector const& in, Value const& p, Element& result)
+		{
+			if (!in.is_contiguous()) {
+				tc::vector_ops::v_pnorm<SizeType>(in, p, result);
+				return;
+			}
+
+			auto const src = in.data();
+
+			result = tc::parallel::sum<Element>(in.size(), [=](std::size_t i) {
+				return static_cast<Element>(std::pow(std::abs(src[i]), p));
+			});
+
+			result = std::pow(result, Value{1.0L} / p);
+		}
+
+		// Vector-scalar elementwise multiplication.
+		template<typename SizeType = std::size_t, class InputVector, typename Element, class OutputVector>
+		void vs_mul(InputVector const& lhs, Element const& rhs, OutputVector& result)
+		{
+			#ifdef _DEBUG
+				assert(lhs.size() == result.size());
+			#endif
+
+			if (!lhs.is_contiguous() || !result.is_contiguous()) {
+				tc::vector_ops::vs_mul<SizeType>(lhs, rhs, result);
+				return;
+			}
+
+			auto const in = lhs.data();
+			auto const out = result.data();
+
+			tc::parallel::for_each_chunk(lhs.size(), [=](std::size_t begin, std::size_t end) {
+				for (std::size_t i = begin; i < end; ++i) {
+					out[i] = in[i] * rhs;
+				}
+			});
+		}
+
+		// Vector-vector elementwise addition.
+		template<typename SizeType = std::size_t, class InputVector1, class InputVector2, class OutputVector>
+		void vv_add(InputVector1 const& lhs, InputVector2 const& rhs, OutputVector& result)
+		{
+			#ifdef _DEBUG
+				assert(lhs.size() == rhs.size());
+				assert(lhs.size() == result.size());
+			#endif
+
+			if (!lhs.is_contiguous() || !rhs.is_contiguous() || !result.is_contiguous()) {
+				tc::vector_ops::vv_add<SizeType>(lhs, rhs, result);
+				return;
+			}
+
+			auto const a = lhs.data();
+			auto const b = rhs.data();
+			auto const out = result.data();
+
+			tc::parallel::for_each_chunk(lhs.size(), [=](std::size_t begin, std::size_t end) {
+				for (std::size_t i = begin; i < end; ++i) {
+					out[i] = a[i] + b[i];
+				}
+			});
+		}
+
+		// Vector-vector cross product (3-vectors only).
+		template<class InputVector1, class InputVector2, class OutputVector>
+		void vv_cprod(InputVector1 const& lhs, InputVector2 const& rhs, OutputVector& result)
+		{
+			#ifdef _DEBUG
+				assert(lhs.size() == 3);
+				assert(rhs.size() == 3);
+				assert(result.size() == 3);
+			#endif
+
+			if (!lhs.is_contiguous() || !rhs.is_contiguous() || !result.is_contiguous()) {
+				tc::vector_ops::vv_cprod(lhs, rhs, result);
+				return;
+			}
+
+			auto const a = lhs.data();
+			auto const b = rhs.data();
+			auto const out = result.data();
+
+			out[0] = a[1] * b[2] - a[2] * b[1];
+			out[1] = a[2] * b[0] - a[0] * b[2];
+			out[2] = a[0] * b[1] - a[1] * b[0];
+		}
+
+		// Vector-vector dot (inner) product.
+		template<typename SizeType = std::size_t, class InputVector1, class InputVector2, typename Element>
+		void vv_dprod(InputVector1 const& lhs, InputVector2 const& rhs, Element& result)
+		{
+			#ifdef _DEBUG
+				assert(lhs.size() == rhs.size());
+			#endif
+
+			if (!lhs.is_contiguous() || !rhs.is_contiguous()) {
+				tc::vector_ops::vv_dprod<SizeType>(lhs, rhs, result);
+				return;
+			}
+
+			auto const a = lhs.data();
+			auto const b = rhs.data();
+
+			result = tc::parallel::sum<Element>(lhs.size(), [=](std::size_t i) {
+				return static_cast<Element>(a[i] * b[i]);
+			});
+		}
+
+		// Vector-vector Hadamard (elementwise) product.
+		template<typename SizeType = std::size_t, class InputVector1, class InputVector2, class OutputVector>
+		void vv_hprod(InputVector1 const& lhs, InputVector2 const& rhs, OutputVector& result)
+		{
+			#ifdef _DEBUG
+				assert(lhs.size() == rhs.size());
+				assert(lhs.size() == result.size());
+			#endif
+
+			if (!lhs.is_contiguous() || !rhs.is_contiguous() || !result.is_contiguous()) {
+				tc::vector_ops::vv_hprod<SizeType>(lhs, rhs, result);
+				return;
+			}
+
+			auto const a = lhs.data();
+			auto const b = rhs.data();
+			auto const out = result.data();
+
+			tc::parallel::for_each_chunk(lhs.size(), [=](std::size_t begin, std::size_t end) {
+				for (std::size_t i = begin; i < end; ++i) {
+					out[i] = a[i] * b[i];
+				}
+			});
+		}
+
+		/* Vector-vector matrix product (column vector by row vector), result = alpha lhs rhs^T + beta result.
+			With `beta` one this is the rank-1 update (ger), accumulating the product into `result` in place, with no
+			temporary matrix. `result` is not read when `beta` is zero.
+			Lines of `result` (rows, or columns if column major) are split across threads. */
+		template<typename SizeType = std::size_t, typename Element1, class InputVector1, class InputVector2, typename Element2, class OutputMatrix>
+		void vv_mprod(Element1 const& alpha, InputVector1 const& lhs, InputVector2 const& rhs, Element2 const& beta, OutputMatrix& result)
+		{
+			#ifdef _DEBUG
+				assert(lhs.size() == result.rows());
+				assert(rhs.size() == result.columns());
+			#endif
+
+			if (!lhs.is_contiguous() || !rhs.is_contiguous()) {
+				tc::vector_ops::vv_mprod<SizeType>(alpha, lhs, rhs, beta, result);
+				return;
+			}
+
+			using value_type = typename OutputMatrix::value_type;
+
+			auto const out = result.data();
+			value_type const s = static_cast<value_type>(alpha);
+			value_type const t = static_cast<value_type>(beta);
+			std::size_t const stride = result.stride();
+
+			// Sets each of `lines` lines of `result` from a scaled copy of `b` (`length` elements), line l scaled by alpha a[l].
+			auto const scaled_lines = [=](auto const a, auto const b, std::size_t lines, std::size_t length) {
+				std::size_t const lines_per_chunk = std::max<std::size_t>(tc::parallel::chunk_size / std::max<std::size_t>(length, 1), 1);
+
+				tc::parallel::for_each_chunk(lines, [=](std::size_t begin, std::size_t end) {
+					for (std::size_t l = begin; l < end; ++l) {
+						value_type const a_l = s * a[l];
+						auto const line = out + l * stride;
+
+						if (t == value_type{}) {
+							for (std::size_t e = 0; e < length; ++e) {
+								line[e] = a_l * b[e];
+							}
+						}
+						else {
+							for (std::size_t e = 0; e < length; ++e) {
+								line[e] = t * line[e] + a_l * b[e];
+							}
+						}
+					}
+				}, lines_per_chunk);
+			};
+
+			// Rows of a row major result are scaled copies of rhs, columns of a column major result scaled copies of lhs.
+			if constexpr (tc::matrix_view::is_column_major_v<OutputMatrix>) {
+				scaled_lines(rhs.data(), lhs.data(), rhs.size(), lhs.size());
+			}
+			else {
+				scaled_lines(lhs.data(), rhs.data(), lhs.size(), rhs.size());
+			}
+		}
+
+		/* Vector-vector matrix product (column vector by row vector).
+			Computed as vv_mprod with alpha one and beta zero. */
+		template<typename SizeType = std::size_t, class InputVector1, class InputVector2, class OutputMatrix>
+		void vv_mprod(InputVector1 const& lhs, InputVector2 const& rhs, OutputMatrix& result)
+		{
+			using value_type = typename OutputMatrix::value_type;
+
+			vv_mprod<SizeType>(value_type{1}, lhs, rhs, value_type{}, result);
+		}
+
+		// Vector-vector elementwise subtraction.
+		template<typename SizeType = std::size_t, class InputVector1, class InputVector2, class OutputVector>
+		void vv_sub(InputVector1 const& lhs, InputVector2 const& rhs, OutputVector& result)
+		{
+			#ifdef _DEBUG
+				assert(lhs.size() == rhs.size());
+				assert(lhs.size() == result.size());
+			#endif
+
+			if (!lhs.is_contiguous() || !rhs.is_contiguous() || !result.is_contiguous()) {
+				tc::vector_ops::vv_sub<SizeType>(lhs, rhs, result);
+				return;
+			}
+
+			auto const a = lhs.data();
+			auto const b = rhs.data();
+			auto const out = result.data();
+
+			tc::parallel::for_each_chunk(lhs.size(), [=](std::size_t begin, std::size_t end) {
+				for (std::size_t i = begin; i < end; ++i) {
+					out[i] = a[i] - b[i];
+				}
+			});
+		}
+
 	}
 }
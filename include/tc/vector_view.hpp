@@ -7,13 +7,14 @@
 #include <iterator>				// std::data, std::size
 #include <memory>				// std::pointer_traits, std::addressof
 #include <stdexcept>			// std::out_of_range
-#include <type_traits>			// std::remove_cv_t
+#include <type_traits>			// std::remove_cv_t, std::enable_if_t, std::is_same_v
 
 
 namespace tc {
 	namespace vector_view {
 
-		/* Non-owning view of a contiguous array for use as a mathematical vector.
+		/* Non-owning view of an array for use as a mathematical vector.
+			Consecutive elements are `stride` elements apart, 1 (contiguous) unless constructed otherwise.
 			Element access is 1-indexed. */
 		template<typename T>
 		class vector_view {
@@ -48,13 +49,22 @@ namespace tc {
 			// Constructor from pointer to array and size.
 			vector_view(pointer pointer, size_type size) :
 				_data{pointer},
-				_size{size}
+				_size{size},
+				_stride{1}
+			{}
+
+			// Constructor from pointer to array, size and stride between elements.
+			vector_view(pointer pointer, size_type size, size_type stride) :
+				_data{pointer},
+				_size{size},
+				_stride{stride}
 			{}
 			
 			// Constructor from contiguous iterator range.
 			template<typename ContiguousIterator>
 			vector_view(ContiguousIterator begin, ContiguousIterator end) :
-				_size(end - begin)
+				_size(end - begin),
+				_stride{1}
 			{
 				/* Need to handle a range such as [container.end(), container.end()).
 					Valid, but taking the address of the end iterator will probably be UB. 
@@ -67,11 +77,13 @@ namespace tc {
 				}
 			}
 
-			// Constructor from generic contiguous container.
-			template<class Container>
+			/* Constructor from generic contiguous container.
+				Excludes vector_view itself, so copying a non-const view keeps its stride. */
+			template<class Container, typename = std::enable_if_t<!std::is_same_v<std::remove_cv_t<Container>, vector_view>>>
 			vector_view(Container& container) :
 				_data{std::data(container)},
-				_size{std::size(container)}
+				_size{std::size(container)},
+				_stride{1}
 			{}
 
 			
@@ -91,12 +103,18 @@ namespace tc {
 					assert(index > 0 && index <= _size);
 				#endif
 				
-				return _data[index - 1];
+				return _data[(index - 1) * _stride];
 			}
 
 			
 			/* General member functions */
 
+			// Checks whether the viewed elements are contiguous.
+			bool is_contiguous() const
+			{
+				return _stride == 1 || _size <= 1;
+			}
+
 			// Gets a pointer to the start of the viewed array.
 			pointer data() const
 			{
@@ -109,6 +127,12 @@ namespace tc {
 				return _size;
 			}
 
+			// Gets the number of elements between consecutive viewed elements.
+			size_type stride() const
+			{
+				return _stride;
+			}
+
 
 		private:
 
@@ -119,6 +143,9 @@ namespace tc {
 			
 			// Number of viewed elements.
 			size_type _size;
+
+			// Number of elements between consecutive viewed elements.
+			size_type _stride;
 		};
 
 	}
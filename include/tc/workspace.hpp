@@ -0,0 +1,506 @@
+#pragma once
+
+#include <algorithm>		// std::max
+#include <array>			// std::array
+#ifdef _DEBUG
+	#include <cassert>		// assert
+#endif
+#include <cstddef>			// std::byte, std::size_t
+#include <memory>			// std::uninitialized_default_construct_n
+#include <mutex>			// std::mutex, std::lock_guard
+#include <type_traits>		// std::is_trivially_destructible_v
+#include <utility>			// std::exchange, std::move
+#include <vector>			// std::vector
+#include "aligned.hpp"		// tc::aligned::alignment, tc::aligned::allocate, tc::aligned::unique_array
+
+
+namespace tc {
+	namespace workspace {
+
+		/* Bump allocator for scratch buffers.
+			Allocations are carved from large aligned blocks by advancing an offset, and are freed all at once by rewinding
+			to a marker (see scope), so they must be released in the reverse order they were made.
+			Blocks are kept when released. When the arena is rewound to empty while it holds more than one block, the blocks
+			are replaced by a single block of their total size, so once the arena has grown to its high-water mark it
+			allocates nothing more from the heap.
+			Not thread safe, each thread uses its own arena (see local_arena). */
+		class arena {
+		public:
+
+			/* Member type aliases */
+
+			using size_type = std::size_t;
+
+
+			/* Member types */
+
+			// Position in an arena, returned by mark and passed back to release.
+			struct marker {
+				size_type block;
+				size_type offset;
+			};
+
+
+			/* Member constants */
+
+			// Size in bytes of the first block.
+			static constexpr size_type min_block_size = size_type{1} << 16;
+
+
+			/* Special members */
+
+			// Destructor.
+			~arena() = default;
+
+			// Default constructor, an arena with no blocks.
+			arena() :
+				_blocks{},
+				_block{0},
+				_offset{0}
+			{}
+
+			// Copy constructor - deleted, arenas own their blocks.
+			arena(arena const&) = delete;
+
+			// Move constructor, `other` is left with no blocks.
+			arena(arena&& other) noexcept :
+				_blocks{std::move(other._blocks)},
+				_block{std::exchange(other._block, 0)},
+				_offset{std::exchange(other._offset, 0)}
+			{}
+
+
+			/* Operators */
+
+			// Simple assignment - copy - deleted, arenas own their blocks.
+			arena& operator=(arena const&) = delete;
+
+			// Simple assignment - move - deleted, an arena is only moved while it has no live allocations.
+			arena& operator=(arena&&) = delete;
+
+
+			/* General member functions */
+
+			/* Allocates `bytes` bytes aligned to tc::aligned::alignment bytes.
+				Returns nullptr if `bytes` is zero. */
+			void* allocate_bytes(size_type bytes)
+			{
+				if (bytes == 0) {
+					return nullptr;
+				}
+
+				bytes = (bytes + tc::aligned::alignment - 1) / tc::aligned::alignment * tc::aligned::alignment;
+
+				for (; _block < _blocks.size(); ++_block, _offset = 0) {
+					if (_offset + bytes <= _blocks[_block].size) {
+						return _blocks[_block].data.get() + std::exchange(_offset, _offset + bytes);
+					}
+				}
+
+				size_type const size = std::max({bytes, 2 * capacity(), min_block_size});
+
+				_blocks.push_back({tc::aligned::allocate<std::byte>(size), size});
+				_block = _blocks.size() - 1;
+				_offset = bytes;
+				return _blocks.back().data.get();
+			}
+
+			/* Allocates an array of `n` default-initialised elements aligned to tc::aligned::alignment bytes.
+				Elements of trivial types are left uninitialised. Destructors are never run, so T must be trivially
+				destructible. Returns nullptr if `n` is zero. */
+			template<typename T>
+			T* allocate(size_type n)
+			{
+				static_assert(std::is_trivially_destructible_v<T>, "arena allocations are released without destruction");
+				static_assert(alignof(T) <= tc::aligned::alignment, "over-aligned type");
+
+				T* const p = static_cast<T*>(allocate_bytes(n * sizeof(T)));
+
+				std::uninitialized_default_construct_n(p, n);
+				return p;
+			}
+
+			// Gets the total size in bytes of the blocks held.
+			size_type capacity() const
+			{
+				size_type size = 0;
+
+				for (auto const& block : _blocks) {
+					size += block.size;
+				}
+				return size;
+			}
+
+			// Gets the current position, to release everything allocated after it later.
+			marker mark() const
+			{
+				return {_block, _offset};
+			}
+
+			/* Frees everything allocated since `position` was taken by mark.
+				Markers must be released in the reverse order they were taken. */
+			void release(marker position)
+			{
+				#ifdef _DEBUG
+					assert(position.block < _block || (position.block == _block && position.offset <= _offset));
+				#endif
+
+				_block = position.block;
+				_offset = position.offset;
+
+				if (_block == 0 && _offset == 0 && _blocks.size() > 1) {
+					size_type const size = capacity();
+
+					_blocks.clear();
+					_blocks.push_back({tc::aligned::allocate<std::byte>(size), size});
+				}
+			}
+
+
+		private:
+
+			/* Member types */
+
+			// Owned block of memory.
+			struct block {
+				tc::aligned::unique_array<std::byte> data;
+				size_type size;
+			};
+
+
+			/* Member variables */
+
+			// Blocks, in the order they are used.
+			std::vector<block> _blocks;
+
+			// Index of the block being allocated from.
+			size_type _block;
+
+			// Offset in bytes of the next allocation in the current block.
+			size_type _offset;
+		};
+
+		// Gets the arena of the calling thread, used for kernel scratch buffers.
+		inline arena& local_arena()
+		{
+			thread_local arena instance;
+			return instance;
+		}
+
+
+		/* Scoped allocation from an arena.
+			Everything allocated through the scope, or from its arena while it is alive, is freed when it is destroyed.
+			Scopes on the same arena must be destroyed in the reverse order they were created, as they are by nesting. */
+		class scope {
+		public:
+
+			/* Member type aliases */
+
+			using size_type = std::size_t;
+
+
+			/* Special members */
+
+			// Destructor, frees everything allocated since construction.
+			~scope()
+			{
+				_arena.release(_marker);
+			}
+
+			// Constructor from arena, by default the arena of the calling thread.
+			explicit scope(arena& source = local_arena()) :
+				_arena{source},
+				_marker{source.mark()}
+			{}
+
+			// Copy constructor - deleted, scopes are tied to their lifetime.
+			scope(scope const&) = delete;
+
+
+			/* Operators */
+
+			// Simple assignment - copy - deleted, scopes are tied to their lifetime.
+			scope& operator=(scope const&) = delete;
+
+
+			/* General member functions */
+
+			/* Allocates an array of `n` default-initialised elements aligned to tc::aligned::alignment bytes.
+				See arena::allocate. */
+			template<typename T>
+			T* allocate(size_type n)
+			{
+				return _arena.template allocate<T>(n);
+			}
+
+
+		private:
+
+			/* Member variables */
+
+			// Arena allocated from.
+			arena& _arena;
+
+			// Position of the arena on construction.
+			arena::marker _marker;
+		};
+
+
+		class pool;
+
+		/* Array of elements on loan from a pool, returned to the pool on destruction.
+			Move-only. Elements of trivial types are left uninitialised. */
+		template<typename T>
+		class buffer {
+		public:
+
+			/* Member type aliases */
+
+			using value_type = T;
+			using size_type = std::size_t;
+			using pointer = value_type*;
+			using const_pointer = value_type const*;
+
+
+			/* Special members */
+
+			// Destructor, returns the array to its pool.
+			~buffer();
+
+			// Default constructor, an empty buffer.
+			buffer() :
+				_pool{nullptr},
+				_data{nullptr},
+				_size{0},
+				_size_class{0}
+			{}
+
+			// Copy constructor - deleted, buffers are move-only.
+			buffer(buffer const&) = delete;
+
+			// Move constructor, `other` is left empty.
+			buffer(buffer&& other) noexcept :
+				_pool{std::exchange(other._pool, nullptr)},
+				_data{std::exchange(other._data, nullptr)},
+				_size{std::exchange(other._size, 0)},
+				_size_class{other._size_class}
+			{}
+
+
+			/* Operators */
+
+			// Simple assignment - copy - deleted, buffers are move-only.
+			buffer& operator=(buffer const&) = delete;
+
+			// Simple assignment - move, the current array is returned to its pool and `other` is left empty.
+			buffer& operator=(buffer&& other) noexcept;
+
+
+			/* General member functions */
+
+			// Gets the pointer to the start of the array, aligned to tc::aligned::alignment bytes.
+			pointer data()
+			{
+				return _data;
+			}
+
+			// Gets the pointer to the start of the array, aligned to tc::aligned::alignment bytes.
+			const_pointer data() const
+			{
+				return _data;
+			}
+
+			// Gets the number of elements.
+			size_type size() const
+			{
+				return _size;
+			}
+
+
+		private:
+
+			friend class pool;
+
+			// Constructor from pool, array, number of elements and size class.
+			buffer(pool* owner, pointer data, size_type size, size_type size_class) :
+				_pool{owner},
+				_data{data},
+				_size{size},
+				_size_class{size_class}
+			{}
+
+
+			/* Member variables */
+
+			// Pool the array is on loan from.
+			pool* _pool;
+
+			// Array of elements.
+			pointer _data;
+
+			// Number of elements.
+			size_type _size;
+
+			// Size class of the array.
+			size_type _size_class;
+		};
+
+
+		/* Pool of aligned arrays sorted into power-of-two size classes.
+			A returned array is kept on its size class's free list and handed out again by the next acquire of that class,
+			so arrays for recurring shapes (eg the temporaries of a training step) are only allocated once.
+			Arrays are never freed before the pool is destroyed, except by trim.
+			Thread safe, but each thread normally uses its own pool (see local_pool) so that threads do not contend. */
+		class pool {
+		public:
+
+			/* Member type aliases */
+
+			using size_type = std::size_t;
+
+
+			/* Member constants */
+
+			// Number of size classes, class c holds arrays of (tc::aligned::alignment << c) bytes.
+			static constexpr size_type size_classes = 48;
+
+
+			/* Special members */
+
+			// Destructor, frees every array held. Buffers on loan must not outlive the pool.
+			~pool() = default;
+
+			// Default constructor, an empty pool.
+			pool() = default;
+
+			// Copy constructor - deleted, pools own their arrays.
+			pool(pool const&) = delete;
+
+
+			/* Operators */
+
+			// Simple assignment - copy - deleted, pools own their arrays.
+			pool& operator=(pool const&) = delete;
+
+
+			/* General member functions */
+
+			/* Gets an array of `n` default-initialised elements aligned to tc::aligned::alignment bytes, reusing a returned
+				array of the same size class if there is one. Elements of trivial types are left uninitialised. */
+			template<typename T>
+			buffer<T> acquire(size_type n)
+			{
+				static_assert(std::is_trivially_destructible_v<T>, "pooled arrays are returned without destruction");
+				static_assert(alignof(T) <= tc::aligned::alignment, "over-aligned type");
+
+				if (n == 0) {
+					return {};
+				}
+
+				size_type const size_class = class_of(n * sizeof(T));
+				std::byte* data = nullptr;
+
+				{
+					std::lock_guard<std::mutex> lock{_mutex};
+					auto& free = _free[size_class];
+
+					if (!free.empty()) {
+						data = free.back().release();
+						free.pop_back();
+					}
+				}
+
+				if (data == nullptr) {
+					data = tc::aligned::allocate<std::byte>(tc::aligned::alignment << size_class).release();
+				}
+
+				T* const p = reinterpret_cast<T*>(data);
+
+				std::uninitialized_default_construct_n(p, n);
+				return {this, p, n, size_class};
+			}
+
+			// Frees every array held that is not on loan.
+			void trim()
+			{
+				std::lock_guard<std::mutex> lock{_mutex};
+
+				for (auto& free : _free) {
+					free.clear();
+					free.shrink_to_fit();
+				}
+			}
+
+
+		private:
+
+			template<typename T>
+			friend class buffer;
+
+			// Gets the smallest size class holding `bytes` bytes.
+			static size_type class_of(size_type bytes)
+			{
+				size_type size_class = 0;
+
+				while ((tc::aligned::alignment << size_class) < bytes) {
+					++size_class;
+				}
+
+				#ifdef _DEBUG
+					assert(size_class < size_classes);
+				#endif
+
+				return size_class;
+			}
+
+			// Takes back an array of the given size class.
+			void give_back(void* data, size_type size_class)
+			{
+				tc::aligned::unique_array<std::byte> array{static_cast<std::byte*>(data)};
+				std::lock_guard<std::mutex> lock{_mutex};
+
+				_free[size_class].push_back(std::move(array));
+			}
+
+
+			/* Member variables */
+
+			// Guards the free lists.
+			std::mutex _mutex;
+
+			// Arrays not on loan, by size class.
+			std::array<std::vector<tc::aligned::unique_array<std::byte>>, size_classes> _free;
+		};
+
+		// Gets the pool of the calling thread. Buffers from it must not outlive the thread.
+		inline pool& local_pool()
+		{
+			thread_local pool instance;
+			return instance;
+		}
+
+		template<typename T>
+		buffer<T>::~buffer()
+		{
+			if (_pool != nullptr) {
+				_pool->give_back(_data, _size_class);
+			}
+		}
+
+		template<typename T>
+		buffer<T>& buffer<T>::operator=(buffer&& other) noexcept
+		{
+			if (this != &other) {
+				if (_pool != nullptr) {
+					_pool->give_back(_data, _size_class);
+				}
+				_pool = std::exchange(other._pool, nullptr);
+				_data = std::exchange(other._data, nullptr);
+				_size = std::exchange(other._size, 0);
+				_size_class = other._size_class;
+			}
+			return *this;
+		}
+
+	}
+}
@@ -0,0 +1,185 @@
+#include <algorithm>		// std::max, std::min
+#include <cmath>			// std::abs, std::exp, std::exp2, std::ilogb, std::isfinite, std::ldexp, std::log, std::log2, std::tanh
+#include <cstddef>			// std::size_t
+#include <cstdint>			// std::uint32_t, std::uint64_t
+#include <cstdio>			// std::printf
+#include <cstdlib>			// std::strtoull, EXIT_FAILURE, EXIT_SUCCESS
+#include <cstring>			// std::memcpy
+#include <limits>			// std::numeric_limits
+#include <random>			// std::mt19937_64, std::uniform_real_distribution
+#include <type_traits>		// std::is_same_v
+#include <vector>			// std::vector
+#include "../include/tc/math_f.hpp"		// tc::math_f::batch_exp, tc::math_f::batch_log, tc::math_f::batch_sigmoid, tc::math_f::batch_sigmoid_deriv, tc::math_f::batch_tanh
+
+
+/* Accuracy sweep of the tc::math_f kernels, checking the maximum errors documented in math_f.hpp.
+	Each kernel is run through its batch function (the vectorised path) on random inputs spread over its whole input
+	range, plus inputs known to be hard, and compared against a long double reference. The error of each result is
+	measured in units in the last place of the reference rounded to the kernel's type, with subnormal results measured
+	in the ulp of the smallest normal exponent.
+	The bounds depend on whether the compiler fuses multiply-adds: builds targeting FMA (__FMA__, eg -march=native on
+	recent x86) check the FMA column, others the plain column.
+	Usage: accuracy_test [samples per kernel and type], 20000000 by default.
+	Exits with failure if any kernel exceeds its documented bound. */
+
+// Documented maximum errors in ulp, see math_f.hpp.
+struct bound {
+	char const* name;
+	double float_plain;
+	double float_fma;
+	double double_plain;
+	double double_fma;
+};
+
+constexpr bound bounds[] = {
+	{"exp",				1.5,	1.0,	1.5,	1.0},
+	{"log",				1.0,	1.0,	1.0,	1.0},
+	{"tanh",			3.5,	3.5,	3.5,	3.5},
+	{"sigmoid",			2.5,	2.5,	2.5,	2.5},
+	{"sigmoid_deriv",	3.5,	2.5,	3.5,	2.5}
+};
+
+// Gets the error of `result` in ulp of `reference` rounded to T. References that round to infinity must be matched.
+template<typename T>
+double ulp_error(T result, long double reference)
+{
+	T const rounded = static_cast<T>(reference);
+
+	if (!std::isfinite(rounded) || !std::isfinite(result)) {
+		return result == rounded || (result != result && rounded != rounded) ? 0 : std::numeric_limits<double>::infinity();
+	}
+
+	int const exponent = reference == 0 ? std::numeric_limits<T>::min_exponent - 1
+		: std::max(std::ilogb(reference), std::numeric_limits<T>::min_exponent - 1);
+	long double const ulp = std::ldexp(1.0L, exponent - (std::numeric_limits<T>::digits - 1));
+
+	return static_cast<double>(std::abs(static_cast<long double>(result) - reference) / ulp);
+}
+
+// Largest error of a kernel and the input giving it.
+struct worst {
+	double error = 0;
+	long double input = 0;
+};
+
+// Runs `batch` on `inputs` and records the largest error against `reference`.
+template<typename T, typename Batch, typename Reference>
+void sweep(std::vector<T> const& inputs, Batch batch, Reference reference, worst& w)
+{
+	std::vector<T> outputs(inputs.size());
+
+	batch(inputs.data(), inputs.size(), outputs.data());
+
+	for (std::size_t i = 0; i < inputs.size(); ++i) {
+		double const error = ulp_error<T>(outputs[i], reference(static_cast<long double>(inputs[i])));
+
+		if (error > w.error) {
+			w.error = error;
+			w.input = inputs[i];
+		}
+	}
+}
+
+// Fills `inputs` with values uniform in [low, high], the first ones taken from `hard`.
+template<typename T>
+void uniform_inputs(std::vector<T>& inputs, std::mt19937_64& generator, double low, double high, std::vector<double> const& hard)
+{
+	std::uniform_real_distribution<double> distribution{low, high};
+
+	for (std::size_t i = 0; i < inputs.size(); ++i) {
+		inputs[i] = static_cast<T>(i < hard.size() ? hard[i] : distribution(generator));
+	}
+}
+
+// Fills `inputs` with values of random sign and magnitude log-uniform in [2^low, 2^high], the first ones from `hard`.
+template<typename T>
+void magnitude_inputs(std::vector<T>& inputs, std::mt19937_64& generator, double low, double high, std::vector<double> const& hard)
+{
+	std::uniform_real_distribution<double> distribution{low, high};
+
+	for (std::size_t i = 0; i < inputs.size(); ++i) {
+		double const magnitude = std::exp2(distribution(generator));
+
+		inputs[i] = static_cast<T>(i < hard.size() ? hard[i] : (generator() & 1 ? magnitude : -magnitude));
+	}
+}
+
+// Fills `inputs` with positive finite values of uniformly random bit patterns, so every binade is covered.
+template<typename T>
+void bit_inputs(std::vector<T>& inputs, std::mt19937_64& generator)
+{
+	using bits_type = typename tc::math_f::float_traits<T>::bits_type;
+
+	bits_type const infinity = tc::math_f::to_bits(std::numeric_limits<T>::infinity());
+
+	for (auto& x : inputs) {
+		x = tc::math_f::from_bits<T>(static_cast<bits_type>(generator()) % infinity);
+	}
+}
+
+// Sweeps every kernel for type T over `samples` inputs each, prints the results and returns the number over bound.
+template<typename T>
+int sweep_type(std::size_t samples, std::mt19937_64& generator)
+{
+	constexpr bool is_float = std::is_same_v<T, float>;
+
+	#if defined(__FMA__)
+		constexpr bool fma = true;
+	#else
+		constexpr bool fma = false;
+	#endif
+
+	using traits = tc::math_f::float_traits<T>;
+
+	std::vector<T> inputs(samples);
+	worst results[5];
+
+	// Hard inputs found by earlier sweeps.
+	std::vector<double> const exp_hard = is_float ? std::vector<double>{-71.0456161} : std::vector<double>{699.04055091015039};
+
+	uniform_inputs(inputs, generator, traits::exp_min, traits::exp_max, exp_hard);
+	sweep(inputs, tc::math_f::batch_exp<T>, [](long double x){ return std::exp(x); }, results[0]);
+
+	bit_inputs(inputs, generator);
+	sweep(inputs, tc::math_f::batch_log<T>, [](long double x){ return std::log(x); }, results[1]);
+
+	magnitude_inputs(inputs, generator, -30, std::log2(static_cast<double>(traits::tanh_max)) + 1, {0.0078109613014998303});
+	sweep(inputs, tc::math_f::batch_tanh<T>, [](long double x){ return std::tanh(x); }, results[2]);
+
+	uniform_inputs(inputs, generator, traits::exp_min, 40, {});
+	sweep(inputs, tc::math_f::batch_sigmoid<T>, [](long double x){ return 1 / (1 + std::exp(-x)); }, results[3]);
+
+	uniform_inputs(inputs, generator, traits::exp_min, -traits::exp_min, {});
+	sweep(inputs, tc::math_f::batch_sigmoid_deriv<T>, [](long double x){
+		long double const e = std::exp(-std::abs(x));
+		return e / ((1 + e) * (1 + e));
+	}, results[4]);
+
+	int failures = 0;
+
+	for (std::size_t i = 0; i < 5; ++i) {
+		double const limit = is_float ? (fma ? bounds[i].float_fma : bounds[i].float_plain) : (fma ? bounds[i].double_fma : bounds[i].double_plain);
+		bool const passed = results[i].error <= limit;
+
+		std::printf("%-14s %-6s %8.3f ulp (bound %.1f) at x = %.17Lg%s\n", bounds[i].name, is_float ? "float" : "double",
+			results[i].error, limit, results[i].input, passed ? "" : "  FAILED");
+		failures += passed ? 0 : 1;
+	}
+	return failures;
+}
+
+int main(int argc, char** argv)
+{
+	std::size_t const samples = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20000000;
+	std::mt19937_64 generator{2024};
+
+	#if defined(__FMA__)
+		std::printf("multiply-adds fused (FMA bounds), %zu samples per kernel\n", samples);
+	#else
+		std::printf("multiply-adds not fused (plain bounds), %zu samples per kernel\n", samples);
+	#endif
+
+	int const failures = sweep_type<float>(samples, generator) + sweep_type<double>(samples, generator);
+
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,425 @@
+#include <algorithm>		// std::equal, std::min
+#include <cmath>			// std::abs, std::sqrt
+#include <cstddef>			// std::size_t
+#include <cstdlib>			// std::strtod, std::strtoull, EXIT_FAILURE, EXIT_SUCCESS
+#include <ctime>			// std::strftime, std::time, std::gmtime
+#include <fstream>			// std::ofstream
+#include <iostream>			// std::cerr, std::cout
+#include <limits>			// std::numeric_limits
+#include <string>			// std::string, std::to_string
+#include <thread>			// std::thread
+#include <utility>			// std::pair
+#include <vector>			// std::vector
+#include "../include/tc/array_ops.hpp"		// tc::array_ops::a_sum
+#include "../include/tc/array_view.hpp"		// tc::array_view::array_view, tc::array_view::array_view_static, tc::array_view::dynamic_extent
+#include "../include/tc/math.hpp"			// tc::math::sigmoid
+#include "../include/tc/matrix_ops.hpp"		// tc::matrix_ops
+#include "../include/tc/matrix_ops_f.hpp"	// tc::matrix_ops_f
+#include "../include/tc/matrix_view.hpp"	// tc::matrix_view::column_major, tc::matrix_view::matrix_view
+#include "../include/tc/mv_ops.hpp"			// tc::mv_ops
+#include "../include/tc/mv_ops_f.hpp"		// tc::mv_ops_f
+#include "../include/tc/random.hpp"			// tc::random::fill_bernoulli, tc::random::fill_normal, tc::random::fill_uniform, tc::random::philox
+#include "../include/tc/vector_ops.hpp"		// tc::vector_ops
+#include "../include/tc/vector_ops_f.hpp"	// tc::vector_ops_f
+#include "../include/tc/vector_view.hpp"	// tc::vector_view::vector_view
+#include "benchmark.hpp"					// benchmark::do_not_optimize, benchmark::options, benchmark::suite
+
+
+/* Benchmarks of the tc operations, each swept over sizes from L1 cache resident to DRAM sized.
+	The reference operations (tc::vector_ops, tc::mv_ops, tc::matrix_ops) are run beside the fast ones (the _f
+	namespaces), and the outputs of each pair are compared once, untimed.
+	Usage: benchmark [--filter text] [--json file] [--max-size elements] [--min-time seconds] [--min-runs n]
+	Sizes are the number of elements of each operand, so a size of 1 << 10 doubles is 8 KiB and 1 << 22 is 32 MiB. */
+
+using vector = tc::vector_view::vector_view<double>;
+using matrix = tc::matrix_view::matrix_view<double>;
+
+// Bytes per element.
+constexpr double element_bytes = sizeof(double);
+
+// Checks whether `fast` matches `reference` to within `tolerance` relative to each reference element.
+bool close(std::vector<double> const& reference, std::vector<double> const& fast, double tolerance)
+{
+	return std::equal(reference.begin(), reference.end(), fast.begin(), fast.end(), [=](double r, double f) {
+		return std::abs(r - f) <= tolerance * std::abs(r);
+	});
+}
+
+// Elementwise vector operations, reference and fast, over vectors of `n` elements.
+void vector_benchmarks(benchmark::suite& suite, std::size_t n, tc::random::philox& generator)
+{
+	std::vector<double> x(n), y(n), reference(n), fast(n);
+	vector const vx{x.data(), n}, vy{y.data(), n};
+	vector vr{reference.data(), n}, vf{fast.data(), n};
+
+	tc::random::fill_normal(x.data(), n, 0.0, 1.0, generator);
+	tc::random::fill_normal(y.data(), n, 0.0, 1.0, generator);
+
+	auto const dn = static_cast<double>(n);
+
+	// Benchmarks the reference and fast versions of an operation writing to a vector, then compares their outputs.
+	auto const pair = [&](std::string const& op, double flops, double bytes, double tolerance, auto&& reference_op, auto&& fast_op) {
+		suite.add(std::cout, "vector_ops." + op, n, flops, bytes, [&]{ reference_op(vr); });
+		suite.add(std::cout, "vector_ops_f." + op, n, flops, bytes, [&]{ fast_op(vf); });
+
+		if (suite.selected("vector_ops." + op) || suite.selected("vector_ops_f." + op)) {
+			reference_op(vr);
+			fast_op(vf);
+			suite.check(std::cout, "vector_ops_f." + op, close(reference, fast, tolerance), "output differs from tc::vector_ops");
+		}
+	};
+
+	pair("v_cpy", 0, 2 * element_bytes * dn, 0,
+		[&](vector& r){ tc::vector_ops::v_cpy(vx, r); },
+		[&](vector& r){ tc::vector_ops_f::v_cpy(vx, r); });
+	pair("v_fill", 0, element_bytes * dn, 0,
+		[&](vector& r){ tc::vector_ops::v_fill(r, 4.6); },
+		[&](vector& r){ tc::vector_ops_f::v_fill(r, 4.6); });
+	pair("vv_add", dn, 3 * element_bytes * dn, 0,
+		[&](vector& r){ tc::vector_ops::vv_add(vx, vy, r); },
+		[&](vector& r){ tc::vector_ops_f::vv_add(vx, vy, r); });
+	pair("vv_hprod", dn, 3 * element_bytes * dn, 0,
+		[&](vector& r){ tc::vector_ops::vv_hprod(vx, vy, r); },
+		[&](vector& r){ tc::vector_ops_f::vv_hprod(vx, vy, r); });
+	pair("sv_mul", dn, 2 * element_bytes * dn, 0,
+		[&](vector& r){ tc::vector_ops::sv_mul(4.6, vx, r); },
+		[&](vector& r){ tc::vector_ops_f::sv_mul(4.6, vx, r); });
+	// When compiling for AVX2 the fast version uses the batch sigmoid of tc::math_f, accurate to a few ulp rather than bitwise equal.
+	pair("v_fn_sigmoid", 0, 2 * element_bytes * dn, 8 * std::numeric_limits<double>::epsilon(),
+		[&](vector& r){ tc::vector_ops::v_fn(vx, tc::math::sigmoid<double>, r); },
+		[&](vector& r){ tc::vector_ops_f::v_fn(vx, tc::math::sigmoid<double>, r); });
+
+	// Reductions, summed in a different order by the fast versions.
+	double dot_reference = 0;
+	double dot_fast = 0;
+
+	suite.add(std::cout, "vector_ops.vv_dprod", n, 2 * dn, 2 * element_bytes * dn, [&]{
+		tc::vector_ops::vv_dprod(vx, vy, dot_reference);
+		benchmark::do_not_optimize(dot_reference);
+	});
+	suite.add(std::cout, "vector_ops_f.vv_dprod", n, 2 * dn, 2 * element_bytes * dn, [&]{
+		tc::vector_ops_f::vv_dprod(vx, vy, dot_fast);
+		benchmark::do_not_optimize(dot_fast);
+	});
+	suite.add(std::cout, "vector_ops.v_esum", n, dn, element_bytes * dn, [&]{
+		tc::vector_ops::v_esum(vx, dot_reference);
+		benchmark::do_not_optimize(dot_reference);
+	});
+	suite.add(std::cout, "vector_ops_f.v_esum", n, dn, element_bytes * dn, [&]{
+		tc::vector_ops_f::v_esum(vx, dot_fast);
+		benchmark::do_not_optimize(dot_fast);
+	});
+}
+
+// Elementwise matrix operations, reference and fast, over square matrices of about `n` elements.
+void matrix_benchmarks(benchmark::suite& suite, std::size_t n, tc::random::philox& generator)
+{
+	std::size_t const side = static_cast<std::size_t>(std::sqrt(static_cast<double>(n)));
+	std::size_t const size = side * side;
+	std::vector<double> x(size), reference(size), fast(size);
+	matrix const mx{x.data(), side, side};
+	matrix mr{reference.data(), side, side}, mf{fast.data(), side, side};
+
+	tc::random::fill_normal(x.data(), size, 0.0, 1.0, generator);
+
+	auto const dn = static_cast<double>(size);
+
+	// Benchmarks the reference and fast versions of an operation writing to a matrix, then compares their outputs.
+	auto const pair = [&](std::string const& op, double flops, double bytes, double tolerance, auto&& reference_op, auto&& fast_op) {
+		suite.add(std::cout, "matrix_ops." + op, size, flops, bytes, [&]{ reference_op(mr); });
+		suite.add(std::cout, "matrix_ops_f." + op, size, flops, bytes, [&]{ fast_op(mf); });
+
+		if (suite.selected("matrix_ops." + op) || suite.selected("matrix_ops_f." + op)) {
+			reference_op(mr);
+			fast_op(mf);
+			suite.check(std::cout, "matrix_ops_f." + op, close(reference, fast, tolerance), "output differs from tc::matrix_ops");
+		}
+	};
+
+	pair("m_cpy", 0, 2 * element_bytes * dn, 0,
+		[&](matrix& r){ tc::matrix_ops::m_cpy(mx, r); },
+		[&](matrix& r){ tc::matrix_ops_f::m_cpy(mx, r); });
+	pair("m_fill", 0, element_bytes * dn, 0,
+		[&](matrix& r){ tc::matrix_ops::m_fill(r, 4.6); },
+		[&](matrix& r){ tc::matrix_ops_f::m_fill(r, 4.6); });
+	pair("mm_add", dn, 3 * element_bytes * dn, 0,
+		[&](matrix& r){ tc::matrix_ops::mm_add(mx, mx, r); },
+		[&](matrix& r){ tc::matrix_ops_f::mm_add(mx, mx, r); });
+	pair("ms_mul", dn, 2 * element_bytes * dn, 0,
+		[&](matrix& r){ tc::matrix_ops::ms_mul(mx, 4.6, r); },
+		[&](matrix& r){ tc::matrix_ops_f::ms_mul(mx, 4.6, r); });
+	pair("m_fn_sigmoid", 0, 2 * element_bytes * dn, 8 * std::numeric_limits<double>::epsilon(),
+		[&](matrix& r){ tc::matrix_ops::m_fn(mx, r, tc::math::sigmoid<double>); },
+		[&](matrix& r){ tc::matrix_ops_f::m_fn(mx, r, tc::math::sigmoid<double>); });
+}
+
+// Matrix-vector products, reference and fast, with square matrices of about `n` elements.
+void mv_benchmarks(benchmark::suite& suite, std::size_t n, tc::random::philox& generator)
+{
+	std::size_t const side = static_cast<std::size_t>(std::sqrt(static_cast<double>(n)));
+	std::vector<double> a(side * side), x(side), reference(side), fast(side);
+	matrix const ma{a.data(), side, side};
+	vector const vx{x.data(), side};
+	vector vr{reference.data(), side}, vf{fast.data(), side};
+
+	tc::random::fill_normal(a.data(), a.size(), 0.0, 1.0, generator);
+	tc::random::fill_normal(x.data(), x.size(), 0.0, 1.0, generator);
+
+	double const flops = 2.0 * static_cast<double>(side * side);
+	double const bytes = element_bytes * static_cast<double>(side * side + 2 * side);
+
+	// Products summed in a different order by the fast versions, compared to within rounding of a side long sum.
+	double const tolerance = 1e-10 * static_cast<double>(side);
+
+	auto const pair = [&](std::string const& op, auto&& reference_op, auto&& fast_op) {
+		suite.add(std::cout, "mv_ops." + op, side * side, flops, bytes, [&]{ reference_op(vr); });
+		suite.add(std::cout, "mv_ops_f." + op, side * side, flops, bytes, [&]{ fast_op(vf); });
+
+		if (suite.selected("mv_ops." + op) || suite.selected("mv_ops_f." + op)) {
+			reference_op(vr);
+			fast_op(vf);
+
+			bool passed = true;
+
+			for (std::size_t i = 0; i < side; ++i) {
+				passed = passed && std::abs(reference[i] - fast[i]) <= tolerance * (1 + std::abs(reference[i]));
+			}
+			suite.check(std::cout, "mv_ops_f." + op, passed, "output differs from tc::mv_ops");
+		}
+	};
+
+	pair("mv_mul",
+		[&](vector& r){ tc::mv_ops::mv_mul(ma, vx, r); },
+		[&](vector& r){ tc::mv_ops_f::mv_mul(ma, vx, r); });
+	pair("mv_tmul",
+		[&](vector& r){ tc::mv_ops::mv_tmul(ma, vx, r); },
+		[&](vector& r){ tc::mv_ops_f::mv_tmul(ma, vx, r); });
+}
+
+/* Element access through array views, summing a 3 dimensional array of about `n` elements with innermost dimensions
+	of 16 by 16. Compares a raw pointer loop with element access through dynamic, static and permuted (strided) views,
+	and with tc::array_ops::a_sum. */
+void array_view_benchmarks(benchmark::suite& suite, std::size_t n, tc::random::philox& generator)
+{
+	constexpr std::size_t inner = 16;
+
+	std::size_t const outer = std::max<std::size_t>(n / (inner * inner), 1);
+	std::size_t const size = outer * inner * inner;
+	std::vector<double> data(size);
+
+	tc::random::fill_uniform(data.data(), size, 0.0, 1.0, generator);
+
+	tc::array_view::array_view<double const, 3> const dynamic{data.data(), outer, inner, inner};
+	tc::array_view::array_view_static<double const, tc::array_view::dynamic_extent, inner, inner> const fixed{data.data(), outer};
+	auto const permuted = dynamic.permuted({2, 1, 0});
+
+	auto const dn = static_cast<double>(size);
+	double const bytes = element_bytes * dn;
+
+	suite.add(std::cout, "array_view.pointer", size, dn, bytes, [&]{
+		double sum = 0;
+
+		for (std::size_t i = 0; i < size; ++i) {
+			sum += data[i];
+		}
+		benchmark::do_not_optimize(sum);
+	});
+	suite.add(std::cout, "array_view.dynamic", size, dn, bytes, [&]{
+		double sum = 0;
+
+		for (std::size_t i = 0; i < outer; ++i) {
+			for (std::size_t j = 0; j < inner; ++j) {
+				for (std::size_t k = 0; k < inner; ++k) {
+					sum += dynamic(i, j, k);
+				}
+			}
+		}
+		benchmark::do_not_optimize(sum);
+	});
+	suite.add(std::cout, "array_view.static", size, dn, bytes, [&]{
+		double sum = 0;
+
+		for (std::size_t i = 0; i < outer; ++i) {
+			for (std::size_t j = 0; j < inner; ++j) {
+				for (std::size_t k = 0; k < inner; ++k) {
+					sum += fixed(i, j, k);
+				}
+			}
+		}
+		benchmark::do_not_optimize(sum);
+	});
+	// Innermost loop over the outermost dimension of the data, a stride of 256 elements.
+	suite.add(std::cout, "array_view.permuted", size, dn, bytes, [&]{
+		double sum = 0;
+
+		for (std::size_t k = 0; k < inner; ++k) {
+			for (std::size_t j = 0; j < inner; ++j) {
+				for (std::size_t i = 0; i < outer; ++i) {
+					sum += permuted(k, j, i);
+				}
+			}
+		}
+		benchmark::do_not_optimize(sum);
+	});
+	suite.add(std::cout, "array_ops.a_sum", size, dn, bytes, [&]{
+		double sum = 0;
+
+		tc::array_ops::a_sum(dynamic, sum);
+		benchmark::do_not_optimize(sum);
+	});
+}
+
+// Bulk random number generation into `n` elements.
+void random_benchmarks(benchmark::suite& suite, std::size_t n, tc::random::philox& generator)
+{
+	std::vector<double> data(n);
+	double const bytes = element_bytes * static_cast<double>(n);
+
+	suite.add(std::cout, "random.fill_uniform", n, 0, bytes, [&]{ tc::random::fill_uniform(data.data(), n, 0.0, 1.0, generator); });
+	suite.add(std::cout, "random.fill_normal", n, 0, bytes, [&]{ tc::random::fill_normal(data.data(), n, 0.0, 1.0, generator); });
+	suite.add(std::cout, "random.fill_bernoulli", n, 0, bytes, [&]{ tc::random::fill_bernoulli(data.data(), n, 0.5, generator); });
+}
+
+/* Matrix-matrix products of `side` by `side` matrices, the fast version of each storage order of the rhs.
+	The reference version is only run for small sides, being cubic time without blocking. */
+void mm_benchmarks(benchmark::suite& suite, std::size_t side, tc::random::philox& generator)
+{
+	std::size_t const size = side * side;
+	std::vector<double> a(size), b(size), reference(size), fast(size);
+	matrix const ma{a.data(), side, side};
+	matrix const mb{b.data(), side, side};
+	tc::matrix_view::matrix_view<double const, tc::matrix_view::column_major> const mbt{b.data(), side, side};
+	matrix mr{reference.data(), side, side}, mf{fast.data(), side, side};
+
+	tc::random::fill_normal(a.data(), size, 0.0, 1.0, generator);
+	tc::random::fill_normal(b.data(), size, 0.0, 1.0, generator);
+
+	auto const ds = static_cast<double>(side);
+	double const flops = 2 * ds * ds * ds;
+	double const bytes = 3 * element_bytes * ds * ds;
+
+	if (side <= 256) {
+		suite.add(std::cout, "matrix_ops.mm_mul", size, flops, bytes, [&]{ tc::matrix_ops::mm_mul(ma, mb, mr); });
+	}
+	suite.add(std::cout, "matrix_ops_f.mm_mul", size, flops, bytes, [&]{ tc::matrix_ops_f::mm_mul(ma, mb, mf); });
+	suite.add(std::cout, "matrix_ops_f.mm_mul_column_major", size, flops, bytes, [&]{ tc::matrix_ops_f::mm_mul(ma, mbt, mf); });
+
+	if (side > 256) {
+		return;
+	}
+
+	auto const matches = [&]{
+		bool passed = true;
+
+		for (std::size_t i = 0; i < size; ++i) {
+			passed = passed && std::abs(reference[i] - fast[i]) <= 1e-10 * ds * (1 + std::abs(reference[i]));
+		}
+		return passed;
+	};
+
+	if (suite.selected("matrix_ops_f.mm_mul")) {
+		tc::matrix_ops::mm_mul(ma, mb, mr);
+		tc::matrix_ops_f::mm_mul(ma, mb, mf);
+		suite.check(std::cout, "matrix_ops_f.mm_mul", matches(), "output differs from tc::matrix_ops");
+	}
+
+	if (suite.selected("matrix_ops_f.mm_mul_column_major")) {
+		tc::matrix_ops::mm_mul(ma, mbt, mr);
+		tc::matrix_ops_f::mm_mul(ma, mbt, mf);
+		suite.check(std::cout, "matrix_ops_f.mm_mul_column_major", matches(), "output differs from tc::matrix_ops");
+	}
+}
+
+// Gets the current UTC time in ISO 8601 format.
+std::string timestamp()
+{
+	std::time_t const now = std::time(nullptr);
+	char text[32];
+
+	std::strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+	return text;
+}
+
+int main(int argc, char** argv)
+{
+	benchmark::options settings;
+	std::string filter;
+	std::string json;
+	std::size_t max_size = std::size_t{1} << 22;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string const arg = argv[i];
+
+		if (i + 1 < argc && arg == "--filter") {
+			filter = argv[++i];
+		}
+		else if (i + 1 < argc && arg == "--json") {
+			json = argv[++i];
+		}
+		else if (i + 1 < argc && arg == "--max-size") {
+			max_size = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else if (i + 1 < argc && arg == "--min-time") {
+			settings.min_time = std::strtod(argv[++i], nullptr);
+		}
+		else if (i + 1 < argc && arg == "--min-runs") {
+			settings.min_runs = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else {
+			std::cerr << "usage: " << argv[0] << " [--filter text] [--json file] [--max-size elements] [--min-time seconds] [--min-runs n]\n";
+			return EXIT_FAILURE;
+		}
+	}
+
+	benchmark::suite suite{settings, filter};
+	tc::random::philox generator{2024};
+
+	benchmark::suite::print_header(std::cout);
+
+	// 8 KiB (L1) to 32 MiB (DRAM) per operand of doubles.
+	for (std::size_t n = std::size_t{1} << 10; n <= max_size; n <<= 3) {
+		vector_benchmarks(suite, n, generator);
+		matrix_benchmarks(suite, n, generator);
+		mv_benchmarks(suite, n, generator);
+		array_view_benchmarks(suite, n, generator);
+		random_benchmarks(suite, n, generator);
+	}
+
+	for (std::size_t side = 64; side * side <= max_size && side <= 2048; side *= 4) {
+		mm_benchmarks(suite, side, generator);
+	}
+
+	if (!json.empty()) {
+		std::ofstream out{json};
+
+		#ifdef _DEBUG
+			char const* const build = "debug";
+		#else
+			char const* const build = "release";
+		#endif
+
+		#if defined(__VERSION__)
+			char const* const compiler = __VERSION__;
+		#else
+			char const* const compiler = "unknown";
+		#endif
+
+		suite.write_json(out, {
+			{"date", timestamp()},
+			{"compiler", compiler},
+			{"build", build},
+			{"threads", std::to_string(std::thread::hardware_concurrency())},
+			{"max_size", std::to_string(max_size)}
+		});
+
+		if (!out) {
+			std::cerr << "cannot write " << json << '\n';
+			return EXIT_FAILURE;
+		}
+	}
+
+	for (auto const& failure : suite.failures()) {
+		std::cerr << "failed: " << failure << '\n';
+	}
+	return suite.failures().empty() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
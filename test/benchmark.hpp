@@ -0,0 +1,320 @@
+#pragma once
+
+#include <algorithm>		// std::max, std::min, std::sort
+#include <chrono>			// std::chrono::duration, std::chrono::steady_clock
+#include <cmath>			// std::floor
+#include <cstddef>			// std::size_t
+#include <cstdio>			// std::snprintf
+#include <ostream>			// std::ostream
+#include <string>			// std::string
+#include <utility>			// std::move, std::pair
+#include <vector>			// std::vector
+
+
+namespace benchmark {
+
+	/* Minimal benchmark harness.
+		Each benchmark is a function run once per repetition, after some untimed warmup runs, until both a minimum number
+		of runs and a minimum total time are reached. The run times are summarised by their median and percentiles,
+		which unlike the mean are not skewed by the occasional run interrupted by the system. The floating point
+		operations and bytes moved per run give GFLOP/s and GB/s at the median time.
+		Results are printed as a table and can be written as JSON to track changes between releases. */
+
+	// Keeps the compiler from optimising away the computation of `value`.
+	template<typename T>
+	inline void do_not_optimize(T const& value)
+	{
+		#if defined(__GNUC__)
+			asm volatile("" : : "r,m"(value) : "memory");
+		#else
+			static_cast<void>(*static_cast<T const volatile*>(&value));
+		#endif
+	}
+
+	// Keeps the compiler from optimising away stores to memory, or hoisting loads out of repeated runs.
+	inline void clobber_memory()
+	{
+		#if defined(__GNUC__)
+			asm volatile("" : : : "memory");
+		#endif
+	}
+
+	// How long and how often each benchmark is run.
+	struct options {
+		// Untimed runs before timing, to fault in pages, fill caches and start the thread pool.
+		std::size_t warmup_runs = 2;
+
+		// Fewest timed runs.
+		std::size_t min_runs = 5;
+
+		// Most timed runs.
+		std::size_t max_runs = 1000;
+
+		// Least total time of the timed runs, in seconds.
+		double min_time = 0.25;
+	};
+
+	// Run times of a benchmark, in seconds, with the work done per run.
+	struct result {
+		// Name of the operation.
+		std::string name;
+
+		// Problem size, usually the number of elements of each operand.
+		std::size_t size;
+
+		// Floating point operations per run.
+		double flops;
+
+		// Bytes read and written per run.
+		double bytes;
+
+		// Number of timed runs.
+		std::size_t runs;
+
+		// Fastest run.
+		double min;
+
+		// 10th percentile.
+		double p10;
+
+		// Median.
+		double median;
+
+		// 90th percentile.
+		double p90;
+
+		// Slowest run.
+		double max;
+
+		// Gets the rate of floating point operations at the median time, in GFLOP/s.
+		double gflops() const
+		{
+			return flops / median * 1e-9;
+		}
+
+		// Gets the rate of memory traffic at the median time, in GB/s.
+		double gbps() const
+		{
+			return bytes / median * 1e-9;
+		}
+	};
+
+	/* Gets the `q` quantile (0 to 1) of `sorted`, interpolating linearly between the closest ranks.
+		`sorted` must be sorted ascending and not empty. */
+	inline double percentile(std::vector<double> const& sorted, double q)
+	{
+		double const position = q * static_cast<double>(sorted.size() - 1);
+		std::size_t const below = static_cast<std::size_t>(std::floor(position));
+		std::size_t const above = std::min(below + 1, sorted.size() - 1);
+		double const fraction = position - static_cast<double>(below);
+
+		return sorted[below] + (sorted[above] - sorted[below]) * fraction;
+	}
+
+	/* Runs `function` as set by `settings` and summarises its run times.
+		`flops` and `bytes` are the work done by one run. */
+	template<typename Function>
+	result measure(std::string name, std::size_t size, double flops, double bytes, Function&& function, options const& settings)
+	{
+		using clock = std::chrono::steady_clock;
+
+		for (std::size_t r = 0; r < settings.warmup_runs; ++r) {
+			function();
+			clobber_memory();
+		}
+
+		std::vector<double> times;
+		double total = 0;
+
+		while (times.size() < settings.max_runs && (times.size() < settings.min_runs || total < settings.min_time)) {
+			auto const before = clock::now();
+
+			function();
+			clobber_memory();
+
+			auto const after = clock::now();
+			double const time = std::chrono::duration<double>(after - before).count();
+
+			times.push_back(time);
+			total += time;
+		}
+
+		std::sort(times.begin(), times.end());
+
+		return {std::move(name), size, flops, bytes, times.size(), times.front(), percentile(times, 0.1), percentile(times, 0.5), percentile(times, 0.9), times.back()};
+	}
+
+	// Escapes `text` for a JSON string.
+	inline std::string json_escape(std::string const& text)
+	{
+		std::string escaped;
+
+		for (char const c : text) {
+			switch (c) {
+			case '"':
+				escaped += "\\\"";
+				break;
+			case '\\':
+				escaped += "\\\\";
+				break;
+			case '\n':
+				escaped += "\\n";
+				break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20) {
+					char code[8];
+
+					std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned>(c));
+					escaped += code;
+				}
+				else {
+					escaped += c;
+				}
+			}
+		}
+		return escaped;
+	}
+
+	// Formats a number for JSON, non-finite numbers (eg rates of zero work) as null.
+	inline std::string json_number(double value)
+	{
+		if (!(value - value == 0)) {
+			return "null";
+		}
+
+		char text[32];
+
+		std::snprintf(text, sizeof(text), "%.9g", value);
+		return text;
+	}
+
+	/* Collection of benchmarks, run as they are added unless filtered out.
+		Names are matched against the filter as substrings, so "vector_ops_f." runs all of the fast vector operations. */
+	class suite {
+	public:
+
+		/* Special members */
+
+		// Constructor from run settings and name filter, empty to run everything.
+		suite(options const& settings, std::string filter) :
+			_settings{settings},
+			_filter{std::move(filter)},
+			_results{},
+			_failures{}
+		{}
+
+
+		/* General member functions */
+
+		/* Runs and records benchmark `name` of size `size` doing `flops` floating point operations and moving `bytes`
+			bytes per call of `function`, and prints its row of the table to `out`. Skipped if filtered out. */
+		template<typename Function>
+		void add(std::ostream& out, std::string const& name, std::size_t size, double flops, double bytes, Function&& function)
+		{
+			if (!selected(name)) {
+				return;
+			}
+
+			_results.push_back(measure(name, size, flops, bytes, function, _settings));
+
+			result const& r = _results.back();
+			char row[160];
+
+			std::snprintf(row, sizeof(row), "%-32s %10zu %6zu %12.3f %12.3f %12.3f %9.2f %9.2f\n",
+				r.name.c_str(), r.size, r.runs, r.median * 1e6, r.p10 * 1e6, r.p90 * 1e6, r.flops ? r.gflops() : 0.0, r.bytes ? r.gbps() : 0.0);
+			out << row << std::flush;
+		}
+
+		/* Records a failed correctness check of benchmark `name`, printing `message` to `out`.
+			Skipped if filtered out. */
+		void check(std::ostream& out, std::string const& name, bool passed, std::string const& message)
+		{
+			if (!passed && selected(name)) {
+				_failures.push_back(name + ": " + message);
+				out << "CHECK FAILED " << _failures.back() << '\n';
+			}
+		}
+
+		// Gets the failed checks.
+		std::vector<std::string> const& failures() const
+		{
+			return _failures;
+		}
+
+		// Prints the header of the table to `out`.
+		static void print_header(std::ostream& out)
+		{
+			char row[160];
+
+			std::snprintf(row, sizeof(row), "%-32s %10s %6s %12s %12s %12s %9s %9s\n",
+				"benchmark", "size", "runs", "median us", "p10 us", "p90 us", "GFLOP/s", "GB/s");
+			out << row;
+		}
+
+		// Gets the results recorded.
+		std::vector<result> const& results() const
+		{
+			return _results;
+		}
+
+		// Checks whether benchmark `name` passes the filter.
+		bool selected(std::string const& name) const
+		{
+			return name.find(_filter) != std::string::npos;
+		}
+
+		/* Writes the results to `out` as a JSON object, with `context` (pairs of keys and string values) describing the
+			build and machine. Times are in nanoseconds. */
+		void write_json(std::ostream& out, std::vector<std::pair<std::string, std::string>> const& context) const
+		{
+			out << "{\n\t\"context\": {";
+
+			for (std::size_t i = 0; i < context.size(); ++i) {
+				out << (i ? ",\n" : "\n") << "\t\t\"" << json_escape(context[i].first) << "\": \"" << json_escape(context[i].second) << '"';
+			}
+			out << "\n\t},\n\t\"benchmarks\": [";
+
+			for (std::size_t i = 0; i < _results.size(); ++i) {
+				result const& r = _results[i];
+
+				out << (i ? ",\n" : "\n") << "\t\t{"
+					<< "\"name\": \"" << json_escape(r.name) << "\", "
+					<< "\"size\": " << r.size << ", "
+					<< "\"runs\": " << r.runs << ", "
+					<< "\"flops\": " << json_number(r.flops) << ", "
+					<< "\"bytes\": " << json_number(r.bytes) << ", "
+					<< "\"min_ns\": " << json_number(r.min * 1e9) << ", "
+					<< "\"p10_ns\": " << json_number(r.p10 * 1e9) << ", "
+					<< "\"median_ns\": " << json_number(r.median * 1e9) << ", "
+					<< "\"p90_ns\": " << json_number(r.p90 * 1e9) << ", "
+					<< "\"max_ns\": " << json_number(r.max * 1e9) << ", "
+					<< "\"gflops\": " << json_number(r.gflops()) << ", "
+					<< "\"gbps\": " << json_number(r.gbps()) << '}';
+			}
+			out << "\n\t],\n\t\"failures\": [";
+
+			for (std::size_t i = 0; i < _failures.size(); ++i) {
+				out << (i ? ", " : "") << '"' << json_escape(_failures[i]) << '"';
+			}
+			out << "]\n}\n";
+		}
+
+
+	private:
+
+		/* Member variables */
+
+		// How long and how often each benchmark is run.
+		options _settings;
+
+		// Substring of the names of benchmarks to run.
+		std::string _filter;
+
+		// Results, in the order run.
+		std::vector<result> _results;
+
+		// Failed correctness checks.
+		std::vector<std::string> _failures;
+	};
+
+}